@@ -0,0 +1,147 @@
+// adc_scan.c
+//   Background scan of the line sensors, see adc_scan.h
+//   rev. Oct. 17, 2026 frame time stamps for the latency histogram (instrument.h)
+//   rev. Oct. 17, 2026 adaptive scan order
+//   rev. Oct. 17, 2026 battery conversion
+//   rev. Oct. 17, 2026 oversampling
+//   rev. Oct. 17, 2026 first version
+
+#include "hal.h"
+#include "adc_scan.h"
+#include "battery.h"
+#include "instrument.h"
+
+static const unsigned char scan_channel[LINE_SENSORS] =
+    { RLS_LeftCH0, RLS_CntLeftCH1, RLS_CenterCH2, RLS_CntRightCH3, RLS_RightCH4 };
+
+static unsigned int frame[2][LINE_SENSORS];
+static volatile unsigned char published;    // half of frame[] holding the latest complete scan
+static volatile unsigned char frame_count;  // incremented each time a frame is published
+static unsigned char filling;               // half of frame[] the ISR is writing into
+static unsigned char next;                  // sensor being converted
+static unsigned char last;                  //   and the last one of this frame
+static volatile unsigned char focus = ADC_FOCUS_NONE;   // from adc_scan_focus()
+static unsigned int sum;                    // conversions of this sensor so far
+static unsigned char samples;
+static volatile unsigned int battery_raw;
+static volatile unsigned char battery_count; // incremented with each battery reading
+static unsigned char battery_pending;       // the conversion running is BATTERY_CH
+
+#ifdef INSTRUMENT
+static unsigned int frame_stamp[2];         // hal_cycles() as each frame's first conversion starts
+#define STAMP_FRAME()  (frame_stamp[filling] = hal_cycles())
+#else
+#define STAMP_FRAME()
+#endif
+
+void adc_scan_start(void)
+{
+    published = 0;
+    filling = 1;
+    next = 0;
+    last = LINE_SENSORS - 1u;
+    focus = ADC_FOCUS_NONE;
+    sum = 0;
+    samples = 0;
+    frame_count = 0;
+    battery_pending = 0;
+    battery_count = 0;
+    STAMP_FRAME();
+    hal_adc_start( scan_channel[0] );
+}
+
+// picks the sensors of the frame about to start and carries the others over
+// from the one just published, so every frame is complete
+static void next_frame(void)
+{
+    unsigned char f = focus, i;
+
+    if (f >= LINE_SENSORS || (frame_count & (ADC_FULL_FRAMES - 1u)) == 0u)
+    {
+        next = 0;
+        last = LINE_SENSORS - 1u;
+        return;
+    }
+    next = f ? f - 1u : 0u;
+    if (next > LINE_SENSORS - ADC_FOCUS_SENSORS) next = LINE_SENSORS - ADC_FOCUS_SENSORS;
+    last = next + ADC_FOCUS_SENSORS - 1u;
+    for (i = 0; i < next; i++) frame[filling][i] = frame[published][i];
+    for (i = last + 1u; i < LINE_SENSORS; i++) frame[filling][i] = frame[published][i];
+}
+
+void adc_scan_isr(void)
+{
+    if (battery_pending)
+    {
+        battery_raw = hal_adc_result();
+        battery_count++;
+        battery_pending = 0;
+        STAMP_FRAME();
+        hal_adc_start( scan_channel[next] );   // back to the line sensors
+        return;
+    }
+    sum += hal_adc_result();
+    if (++samples < (1u << ADC_OVERSAMPLE_SHIFT))
+    {
+        hal_adc_start( scan_channel[next] );  // same sensor again
+        return;
+    }
+    frame[filling][next] = sum >> ADC_OVERSAMPLE_SHIFT;
+    sum = 0;
+    samples = 0;
+    if (next++ == last)
+    {
+        published = filling;   // the frame just finished becomes the one to read
+        filling ^= 1;
+        frame_count++;
+        next_frame();
+        if ((frame_count & (ADC_BATTERY_FRAMES - 1u)) == 0u)
+        {
+            battery_pending = 1;
+            hal_adc_start( BATTERY_CH );
+            return;
+        }
+        STAMP_FRAME();
+    }
+    hal_adc_start( scan_channel[next] );  // acquisition time is inserted by the ADC (ACQT)
+}
+
+// The ISR only writes into the half that is not published, and it can only
+// start writing into the half being copied here after publishing another
+// frame, which changes frame_count. So the copy is retried until frame_count
+// is the same before and after it; no interrupts are disabled.
+unsigned char adc_scan_read(unsigned int *dest)
+{
+    unsigned char count, i;
+    const unsigned int *src;
+
+    do
+    {
+        count = frame_count;
+        src = frame[published];
+        for (i = 0; i < LINE_SENSORS; i++) dest[i] = src[i];
+        LATENCY_FRAME(frame_stamp[published]);
+    } while (count != frame_count);
+
+    return count;
+}
+
+void adc_scan_focus(unsigned char sensor)
+{
+    focus = sensor;     // one byte, the ISR reads it whole
+}
+
+// battery_raw is two bytes the ISR can change between the two reads, so
+// this reads until it gets the same count on either side of the copy
+unsigned char adc_scan_battery(unsigned int *dest)
+{
+    unsigned char count;
+
+    do
+    {
+        count = battery_count;
+        *dest = battery_raw;
+    } while (count != battery_count);
+
+    return count;
+}
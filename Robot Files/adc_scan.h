@@ -0,0 +1,47 @@
+// adc_scan.h
+//   Interrupt driven scan of the five reflective line sensors.
+//   The ADC interrupt converts AN0 to AN4 round robin in the background and
+//   publishes each complete five channel frame into one half of a double
+//   buffer, so a frame read by adc_scan_read() is always from one scan.
+//   rev. Oct. 17, 2026 adaptive scan order: check_sensors() tells the ISR
+//   which sensor is nearest the line (adc_scan_focus()). A frame then converts
+//   only the ADC_FOCUS_SENSORS around it, left to right, and carries the other
+//   readings over from the frame before; every ADC_FULL_FRAMES-th frame
+//   converts all five, and so does every frame while the line is lost or
+//   under an outer sensor. In the simulator the reading nearest the line is
+//   about 410 us old at the control pass instead of 580 us; the outer ones,
+//   which only matter once the line gets there, are at most ADC_FULL_FRAMES
+//   frames old.
+//   rev. Oct. 17, 2026 battery conversion every ADC_BATTERY_FRAMES frames
+//   rev. Oct. 17, 2026 oversampling, ADC_OVERSAMPLE_SHIFT
+//   rev. Oct. 17, 2026 first version
+
+#ifndef ADC_SCAN_H
+#define ADC_SCAN_H
+
+#include "sumovore.h"     // LINE_SENSORS
+
+#define ADC_OVERSAMPLE_SHIFT  1   // each sensor is converted 2^n times in a row and the
+                                  //   frame holds the mean. One conversion takes 62 us, so
+                                  //   a frame takes 5 * 62 us * 2^n (620 us for n = 1)
+#define ADC_BATTERY_FRAMES    64u // one conversion of BATTERY_CH (battery.h) after every
+                                  //   64th frame, every 25 to 40 ms (a power of two)
+#define ADC_FOCUS_SENSORS     3u  // sensors in a focused frame (372 us for n = 1)
+#define ADC_FULL_FRAMES       4u  // every 4th frame converts all five (a power of two)
+#define ADC_FOCUS_NONE        0xffu  // for adc_scan_focus(): full frames only
+
+void adc_scan_start(void);  // starts the first conversion, called from initialization()
+void adc_scan_isr(void);    // called from the low priority ISR when a conversion completes
+
+unsigned char adc_scan_read(unsigned int *dest);
+                 // copies the latest complete frame into dest[LINE_SENSORS] without
+                 // waiting on the converter. Returns the frame count (it wraps at 256),
+                 // which only changes when a new frame has been published.
+void adc_scan_focus(unsigned char sensor);
+                 // sensor (0 Left ... 4 Right) the next frames centre on, or
+                 // ADC_FOCUS_NONE; called by check_sensors() after each new frame
+unsigned char adc_scan_battery(unsigned int *dest);
+                 // the latest BATTERY_CH reading into *dest, returns a count
+                 // that changes with each new reading (0 before the first)
+
+#endif // ADC_SCAN_H
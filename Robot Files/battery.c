@@ -0,0 +1,49 @@
+// battery.c
+//   Battery voltage and duty compensation, see battery.h
+//   rev. Oct. 17, 2026 first version
+
+#include "battery.h"
+#include "adc_scan.h"
+#include "record.h"
+
+unsigned int battery_mv;
+unsigned int battery_scale = 256u;
+unsigned char battery_low;
+
+static unsigned long acc;              // 2^BATTERY_FILTER_SHIFT * battery_mv, keeps the fraction
+static unsigned char last_sample;
+
+void battery_task(void)
+{
+    unsigned int raw, mv, scale;
+    unsigned char sample;
+
+    sample = adc_scan_battery( &raw );
+    if ( sample == last_sample ) return;   // no new conversion since last time
+    last_sample = sample;
+
+    mv = (unsigned int)( ((unsigned long)raw * BATTERY_FULL_SCALE_MV) / 1023u );
+    if ( mv < BATTERY_ABSENT_MV ) return;  // no divider fitted: leave the duties alone
+    if ( battery_mv ) acc = acc - (acc >> BATTERY_FILTER_SHIFT) + mv;
+    else acc = (unsigned long)mv << BATTERY_FILTER_SHIFT;
+    battery_mv = (unsigned int)(acc >> BATTERY_FILTER_SHIFT);
+
+    scale = (unsigned int)( ((unsigned long)BATTERY_NOMINAL_MV << 8) / battery_mv );
+    if ( scale > BATTERY_SCALE_MAX ) scale = BATTERY_SCALE_MAX;
+    if ( scale == battery_scale && ( battery_low || battery_mv >= BATTERY_LOW_MV ) ) return;
+    battery_scale = scale;
+    if ( battery_mv < BATTERY_LOW_MV ) battery_low = 1;
+    record_battery();   // the control loop sees different duties from here on
+}
+
+int battery_duty(int duty)
+{
+    if ( battery_low )
+    {
+        if ( duty > BATTERY_LOW_DUTY ) duty = BATTERY_LOW_DUTY;
+        else if ( duty < -BATTERY_LOW_DUTY ) duty = -BATTERY_LOW_DUTY;
+    }
+    if ( battery_scale == 256u ) return duty;
+    if ( duty < 0 ) return -(int)( ((unsigned long)(unsigned int)-duty * battery_scale) >> 8 );
+    return (int)( ((unsigned long)(unsigned int)duty * battery_scale) >> 8 );
+}
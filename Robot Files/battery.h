@@ -0,0 +1,53 @@
+// battery.h
+//   Battery voltage, duty compensation and the low battery tiers.
+//   The wheel speed a duty gives is about proportional to the pack voltage,
+//   so motor_speeds[] and the PID gains are only right at the voltage they
+//   were tuned at. The ADC scan (adc_scan.c) converts BATTERY_CH once every
+//   ADC_BATTERY_FRAMES frames and battery_task() turns that into
+//     battery_mv     the pack voltage, low pass filtered (the motors pull it
+//                    down under load, which is what the compensation wants)
+//     battery_scale  BATTERY_NOMINAL_MV / battery_mv in 1/256, which
+//                    set_motor_duty() multiplies every duty by, so a fresh
+//                    pack gets less duty and a drained one more, up to
+//                    BATTERY_SCALE_MAX. Full duty cannot be raised, so the
+//                    nominal voltage is one a well used pack still gives
+//                    under load: from a fresh pack down to it the wheel
+//                    speeds stay the same, fast included
+//     battery_low    set once battery_mv has dropped below BATTERY_LOW_MV:
+//                    from then on no duty is asked for above
+//                    BATTERY_LOW_DUTY (before the scaling), the robot runs
+//                    on at a lower top speed. It stays set until reset.
+//   The last tier is the HLVD interrupt (interrupts.c): when the regulator
+//   can no longer hold VDD above 4.59 V, LVtrap() brakes the motors and
+//   stops for good (hal_pic18.c).
+//
+//   Hardware: the ADC reference is VDD, the regulated 5 V, so the pack is
+//   measured through a divider of two equal resistors (10k each) to RE2/AN7
+//   (pin 10). Without the divider the pin reads about 0 and battery_task()
+//   leaves the duties as they are.
+//   rev. Oct. 17, 2026 first version
+
+#ifndef BATTERY_H
+#define BATTERY_H
+
+#include "hal.h"
+
+#define BATTERY_CH            ADC_CH7   // AN7, see above
+#define BATTERY_FULL_SCALE_MV 10000ul   // pack voltage at an ADC reading of 1023 (5 V, halved)
+#define BATTERY_NOMINAL_MV    5400u     // motor_speeds[] and the PID gains are tuned for this
+#define BATTERY_LOW_MV        5000u     // first tier: lower top speed
+#define BATTERY_ABSENT_MV     2000u     // below this there is no divider fitted
+#define BATTERY_LOW_DUTY      600       // largest duty asked for once battery_low is set
+#define BATTERY_SCALE_MAX     320u      // 1.25 in 1/256
+#define BATTERY_FILTER_SHIFT  3         // one pole low pass over 2^n samples
+
+extern unsigned int battery_mv;       // 0 until the first sample
+extern unsigned int battery_scale;    // 256 is 1.0
+extern unsigned char battery_low;
+
+void battery_task(void);   // a scheduler task, see tasks.c
+int battery_duty(int duty);
+                 // duty after the low battery limit and the compensation,
+                 // called by set_motor_duty() before its clamp at +-800
+
+#endif // BATTERY_H
@@ -0,0 +1,163 @@
+// calibration.c
+//   Calibration sweep and EEPROM record for the line sensors, see calibration.h
+//   rev. Oct. 17, 2026 first version
+
+#include <stdio.h>
+#include "sumovore.h"
+#include "hal.h"
+#include "calibration.h"
+#include "eeprom.h"
+#include "telem_frame.h"
+
+unsigned int sensor_threshold[LINE_SENSORS];
+unsigned int sensor_min[LINE_SENSORS];
+unsigned int sensor_gain[LINE_SENSORS];
+unsigned char calibrating;
+
+static unsigned int sweep_ticks;
+static unsigned int seen_min[LINE_SENSORS], seen_max[LINE_SENSORS];
+static unsigned char image[CAL_IMAGE_SIZE];   // EEPROM record, kept for eeprom_task()
+
+// record layout: magic, version, then for each sensor min, threshold and
+// gain (low byte first), then the CRC-8 of everything before it
+static void pack_image(void)
+{
+    unsigned char i, *p = image;
+
+    *p++ = CAL_MAGIC;
+    *p++ = CAL_VERSION;
+    for (i = 0; i < LINE_SENSORS; i++)
+    {
+        *p++ = (unsigned char)sensor_min[i];
+        *p++ = (unsigned char)(sensor_min[i] >> 8);
+        *p++ = (unsigned char)sensor_threshold[i];
+        *p++ = (unsigned char)(sensor_threshold[i] >> 8);
+        *p++ = (unsigned char)sensor_gain[i];
+        *p++ = (unsigned char)(sensor_gain[i] >> 8);
+    }
+    *p = telem_crc8(image, CAL_IMAGE_SIZE - 1u);   // same CRC-8 as the telemetry frames
+}
+
+static unsigned char load_image(void)
+{
+    unsigned char i, *p = image;
+
+    for (i = 0; i < CAL_IMAGE_SIZE; i++) image[i] = eeprom_read((unsigned char)(EE_CALIBRATION + i));
+    if (image[0] != CAL_MAGIC || image[1] != CAL_VERSION
+        || telem_crc8(image, CAL_IMAGE_SIZE - 1u) != image[CAL_IMAGE_SIZE - 1u]) return 0;
+    p += 2;
+    for (i = 0; i < LINE_SENSORS; i++)
+    {
+        sensor_min[i] = p[0] | ((unsigned int)p[1] << 8);
+        sensor_threshold[i] = p[2] | ((unsigned int)p[3] << 8);
+        sensor_gain[i] = p[4] | ((unsigned int)p[5] << 8);
+        p += 6;
+    }
+    return 1;
+}
+
+void calibration_init(void)
+{
+    unsigned char i;
+
+    calibrating = 0;
+    if (!load_image())
+    {
+        for (i = 0; i < LINE_SENSORS; i++)
+        {
+            sensor_min[i] = 0u;
+            sensor_threshold[i] = threshold;
+            sensor_gain[i] = 1u << CAL_GAIN_SHIFT;
+        }
+    }
+    if (hal_ir_detect() == 3u) calibration_start();   // both IR detectors blocked
+}
+
+void calibration_start(void)
+{
+    unsigned char i;
+
+    for (i = 0; i < LINE_SENSORS; i++)
+    {
+        seen_min[i] = 1023u;
+        seen_max[i] = 0u;
+    }
+    sweep_ticks = 0;
+    calibrating = 1;
+}
+
+// derives the new values once the sweep is over, they are only used (and
+// stored) if every sensor saw both the floor and the line
+static void finish(void)
+{
+    unsigned char i;
+    unsigned int range;
+
+    calibrating = 0;
+    for (i = 0; i < LINE_SENSORS; i++)
+    {
+        if (seen_max[i] < seen_min[i] + CAL_MIN_RANGE)
+        {
+            printf("calibration failed, sensor %u saw %u to %u\n\r", i + 1u, seen_min[i], seen_max[i]);
+            return;
+        }
+    }
+    for (i = 0; i < LINE_SENSORS; i++)
+    {
+        range = seen_max[i] - seen_min[i];
+        sensor_min[i] = seen_min[i];
+        sensor_threshold[i] = seen_min[i] + range / 2u;
+        sensor_gain[i] = (unsigned int)((1023ul << CAL_GAIN_SHIFT) / range);
+    }
+    pack_image();
+    eeprom_queue(EE_CALIBRATION, image, CAL_IMAGE_SIZE);   // written in the background
+    printf("calibrated, thresholds %u %u %u %u %u\n\r", sensor_threshold[0], sensor_threshold[1],
+           sensor_threshold[2], sensor_threshold[3], sensor_threshold[4]);
+}
+
+// the sweep rocks the robot on the spot: left for one leg, right for two,
+// left for one to come back, then brakes for one leg to settle
+void calibration_step(void)
+{
+    unsigned char i;
+    unsigned char leg;
+
+    for (i = 0; i < LINE_SENSORS; i++)
+    {
+        if (line_adc[i] < seen_min[i]) seen_min[i] = line_adc[i];
+        if (line_adc[i] > seen_max[i]) seen_max[i] = line_adc[i];
+    }
+    leg = (unsigned char)(sweep_ticks++ / CAL_LEG_TICKS);
+    switch (leg)
+    {
+    case 0:
+    case 3:
+        set_motor_speed(left, rev_slow, 0);
+        set_motor_speed(right, slow, 0);
+        break;
+    case 1:
+    case 2:
+        set_motor_speed(left, slow, 0);
+        set_motor_speed(right, rev_slow, 0);
+        break;
+    case 4:
+        motors_brake_all();
+        break;
+    default:
+        finish();
+        break;
+    }
+}
+
+void calibration_normalise(const unsigned int *raw, unsigned int *norm)
+{
+    unsigned char i;
+    unsigned long v;
+
+    for (i = 0; i < LINE_SENSORS; i++)
+    {
+        if (raw[i] <= sensor_min[i]) v = 0;
+        else v = ((unsigned long)(raw[i] - sensor_min[i]) * sensor_gain[i]) >> CAL_GAIN_SHIFT;
+        norm[i] = (v > 1023ul) ? 1023u : (unsigned int)v;
+    }
+}
@@ -0,0 +1,42 @@
+// calibration.h
+//   Per-sensor thresholds and normalisation gains for the five line sensors.
+//   Each sensor reads the floor and the line a little differently, so one
+//   global threshold leaves some of them seeing the line late (or never).
+//
+//   The values come from a calibration sweep: hold a hand in front of both IR
+//   detectors while the robot is switched on (with the sensor row over the
+//   line) and it rocks left and right on the spot, records the lowest and
+//   highest reading of every sensor, and stores the result in the data EEPROM.
+//   Later boots load them from there. Without a stored calibration every
+//   sensor uses the global threshold and the readings are passed on as they are.
+//   rev. Oct. 17, 2026 first version
+
+#ifndef CALIBRATION_H
+#define CALIBRATION_H
+
+#include "sumovore.h"
+
+#define CAL_MAGIC        0xCAu
+#define CAL_VERSION      1u
+#define CAL_IMAGE_SIZE   (2u + 6u * LINE_SENSORS + 1u)  // magic, version, min/threshold/gain, CRC
+#define CAL_MIN_RANGE    100u    // a sensor must see at least this much of a swing
+#define CAL_GAIN_SHIFT   8       // gains are Q8: 1023 << 8 / (max - min)
+#define CAL_LEG_TICKS    120u    // one swing of the sweep, scheduler ticks. Each
+                                 //   swing should turn the sensor row well past the line
+
+extern unsigned int sensor_threshold[LINE_SENSORS];  // compared with line_adc[] by check_sensors()
+extern unsigned int sensor_min[LINE_SENSORS];        // floor reading
+extern unsigned int sensor_gain[LINE_SENSORS];       // Q8, see calibration_normalise()
+extern unsigned char calibrating;                    // 1 while the sweep has the motors
+
+void calibration_init(void);
+                 // loads the calibration from the EEPROM, or falls back on threshold,
+                 // and starts a sweep if both IR detectors are blocked. Call it after
+                 // initialization() and after any change to threshold.
+void calibration_start(void);
+void calibration_step(void);
+                 // runs in place of motor_control() while calibrating is set
+void calibration_normalise(const unsigned int *raw, unsigned int *norm);
+                 // norm = (raw - min) * 1023 / (max - min), 0 to 1023 for every sensor
+
+#endif // CALIBRATION_H
@@ -0,0 +1,60 @@
+// eeprom.c
+//   Background data EEPROM writes, see eeprom.h
+//   rev. Oct. 17, 2026 first version
+
+#include "hal.h"
+#include "eeprom.h"
+
+struct ee_block
+{
+    unsigned char addr;
+    const unsigned char *src;
+    unsigned char n;
+};
+
+static struct ee_block queue[EEPROM_BLOCKS];
+static unsigned char first, count;
+
+unsigned char eeprom_read(unsigned char addr)
+{
+    return hal_eeprom_read(addr);
+}
+
+unsigned char eeprom_queue(unsigned char addr, const unsigned char *src, unsigned char n)
+{
+    struct ee_block *b;
+
+    if (count == EEPROM_BLOCKS) return 0;
+    b = &queue[(unsigned char)(first + count) % EEPROM_BLOCKS];
+    b->addr = addr;
+    b->src = src;
+    b->n = n;
+    count++;
+    return 1;
+}
+
+unsigned char eeprom_pending(void)
+{
+    return count;
+}
+
+void eeprom_task(void)
+{
+    struct ee_block *b;
+
+    if (count == 0u || hal_eeprom_busy()) return;
+    b = &queue[first];
+    while (b->n != 0u)
+    {
+        b->n--;
+        if (hal_eeprom_read(b->addr) != *b->src)
+        {
+            hal_eeprom_write(b->addr++, *b->src++);   // one byte, then wait for it
+            return;
+        }
+        b->addr++;
+        b->src++;
+    }
+    first = (unsigned char)((first + 1u) % EEPROM_BLOCKS);
+    count--;
+}
@@ -0,0 +1,26 @@
+// eeprom.h
+//   Background writes to the PIC's data EEPROM.
+//   A byte write takes about 4 ms, so blocks are queued and eeprom_task()
+//   starts the next byte write each time the previous one has finished.
+//   Bytes that already hold the value are skipped to save wear.
+//   rev. Oct. 17, 2026 reset log
+//   rev. Oct. 17, 2026 first version
+
+#ifndef EEPROM_H
+#define EEPROM_H
+
+// data EEPROM layout (first 256 bytes only)
+#define EE_CALIBRATION   0x00u    // calibration.c, CAL_IMAGE_SIZE bytes
+#define EE_LAP_MAP       0x40u    // lap_map.c, EE_LAP_MAP_SIZE bytes
+#define EE_RESET_LOG     0xB0u    // persist.c, EE_RESET_LOG_SIZE bytes
+
+#define EEPROM_BLOCKS    4u       // blocks that can be queued at once
+
+unsigned char eeprom_read(unsigned char addr);
+unsigned char eeprom_queue(unsigned char addr, const unsigned char *src, unsigned char n);
+                 // queues n bytes from src for writing at addr. src must not change
+                 // until the block is written. Returns 0 if the queue is full.
+unsigned char eeprom_pending(void);   // blocks still being written
+void eeprom_task(void);               // a scheduler task, see tasks.c
+
+#endif // EEPROM_H
@@ -0,0 +1,65 @@
+// hal.h
+//   Hardware abstraction layer for the sumovore line follower.
+//   sumovore.c and motor_control.c reach the ADC, the PWM outputs, the motor
+//   direction lines and the LEDs only through these functions.
+//     hal_pic18.c    -- PIC18F4525 on brainboard 2 (the robot)
+//     sim/hal_sim.c  -- Linux simulator build (see sim/Makefile)
+//   rev. Oct. 17, 2026 ADC_CH7 for the simulator
+//   rev. Oct. 17, 2026 data EEPROM and IR detectors
+//   rev. Oct. 17, 2026 first version
+
+#ifndef HAL_H
+#define HAL_H
+
+#ifdef HAL_SIM             // the simulator has no adc.h from the peripheral library,
+#define ADC_CH0  0u        //   channels are plain AN numbers there
+#define ADC_CH1  1u
+#define ADC_CH2  2u
+#define ADC_CH3  3u
+#define ADC_CH4  4u
+#define ADC_CH7  7u        // the battery, battery.h
+#else
+#include <xc.h>            // ADC_CH0 ... ADC_CH4 (RLS_LeftCH0 ...) come from adc.h
+#endif
+
+#include "sumovore.h"
+
+unsigned int hal_adc_convert(unsigned char channel);
+                 // starts a conversion on channel (RLS_LeftCH0 ... RLS_RightCH4)
+                 // and waits for the 10 bit result
+void hal_adc_start(unsigned char channel);
+                 // selects channel and starts a conversion without waiting,
+                 // the ADC interrupt calls adc_scan_isr() when it is done
+unsigned int hal_adc_result(void);
+                 // 10 bit result of the last conversion
+void hal_set_pwm(enum motor_selection the_motor, unsigned int duty_cycle);
+                 // duty_cycle 0 to 800 (800 is 100%)
+void hal_set_direction(enum motor_selection the_motor, unsigned char fwd, unsigned char fwd_cmp);
+                 // drives the two direction lines of one motor
+                 //   fwd = YES, fwd_cmp = NO  forward
+                 //   fwd = NO,  fwd_cmp = YES reverse
+                 //   fwd = NO,  fwd_cmp = NO  dead short (dynamic braking)
+void hal_set_leds(unsigned char pattern);
+                 // bit 0 is LED1 ... bit 4 is LED5, a 1 turns the LED on
+unsigned char hal_uart_tx_ready(void);
+                 // 1 when the USART can take another byte
+void hal_uart_write(unsigned char c);
+                 // hands one byte to the USART (only when it is ready)
+void hal_uart_tx_irq(unsigned char on);
+                 // enables or disables the transmit interrupt, which calls
+                 // uart_tx_isr() whenever the USART can take another byte
+unsigned char hal_tick_phase(void);
+                 // how far the current scheduler tick has run, 0 to 255
+unsigned int hal_cycles(void);
+                 // free running instruction cycle count (Timer1, 125 ns), wraps at 65536
+void hal_idle(void);
+                 // called while sched_run() waits for the next tick
+unsigned char hal_eeprom_read(unsigned char addr);
+void hal_eeprom_write(unsigned char addr, unsigned char data);
+                 // starts writing one byte of the data EEPROM, it takes about 4 ms
+unsigned char hal_eeprom_busy(void);
+                 // 1 until the last hal_eeprom_write() has finished
+unsigned char hal_ir_detect(void);
+                 // bit 0 is LeftIR, bit 1 RightIR, a 1 means an object is in front
+
+#endif // HAL_H
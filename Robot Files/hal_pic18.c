@@ -0,0 +1,619 @@
+
+// File hal_pic18.c (split out of sumovore.c by Dan Peirce B.Sc.)
+ 
+// Kwantlen Polytechnic University 
+// apsc1299
+
+// PIC18F4525 (brainboard 2) implementation of the functions declared in hal.h
+// together with the board bring-up, reset codes and LVD handling.
+
+// rev. Oct. 17, 2026 hal_eeprom_write() leaves GIEH as it found it
+// rev. Oct. 17, 2026 hal_cycles() holds off the low priority interrupt, whose ADC
+//                    frame stamps (INSTRUMENT) also read Timer1
+// rev. Oct. 17, 2026 SUPERVISOR: watchdog on, warm restart after a non-POR reset (persist.h)
+// rev. Oct. 17, 2026 the reset codes and gtrap() flash the LEDs from Timer0 (led_code.h)
+//                    instead of counting loops; with FAST_START a POR or BOR shows
+//                    its code while the robot runs
+// rev. Oct. 17, 2026 battery voltage on AN7; LVtrap() brakes the motors and then
+//                    sets the ports to inputs (the HLVD interrupt no longer does)
+// rev. Oct. 17, 2026 500000 baud for the flight recorder (RECORD) as for TELEMETRY
+// rev. Oct. 17, 2026 data EEPROM writes and IR detector reads for hal.h
+// rev. Oct. 17, 2026 USART transmit is interrupt driven once initialization() is done (uart_tx.c)
+// rev. Oct. 17, 2026 Timer1 free runs as an instruction cycle counter (instrument.h)
+// rev. Oct. 17, 2026 Timer0 free runs as the scheduler tick (low priority interrupt)
+// rev. Oct. 17, 2026 ADC runs interrupt driven (low priority), see adc_scan.c
+// rev. Oct. 17, 2026 split from sumovore.c so that sumovore.c and motor_control.c
+//                    only touch the hardware through hal.h (sim/hal_sim.c is the
+//                    Linux simulator version of this file)
+// rev. May 15&16, 2013 New function reset_codes() and many new comments for
+//                      reset functins and LVD fucntions.
+// rev. May 14, 2011 turned watchdog timer off
+// rev. June 18, 2010 added LED error codes to traps in reset functions
+// rev. April 30, 2010 to add reliability features (wdt,bor,lvd and stack overflow)
+// rev. Nov. 17 2009 to make use of new LED macro's,
+//        to incorparate #pragma lines and
+//        to point to osc.h in Functions folder
+// rev. june 2009 for dynamic braking
+// rev. May 22, 2009 to refect changes for BB2
+// rev. March 13, 2007
+// rev. March 2, 2007
+#ifdef SUPERVISOR
+#pragma config WDT = ON       // rev. Oct. 17, 2026 on for the supervisor (persist.h), main()
+                            // clears it every scheduler tick
+#else
+#pragma config WDT = OFF      // rev. May 14, 2011 **** watchdog timer off *****
+                            // reset if the watchdog timer times out
+#endif
+#pragma config WDTPS = 8     // rev. April 30, 2010   4 ms * 8 = 32 ms
+#pragma config BOREN = ON // hardware enable BOR 
+                            // rev. April 30, 2010
+#pragma config BORV = 0   // BOR voltage set between
+                          // 4.36 and 4.82
+                          // rev. April 30, 2010
+#pragma config STVREN = ON  // reset on a stack overflow
+                            // rev. April 30, 2010
+
+#pragma config OSC = INTIO67  // allows osc1 (pin 13) and osc2 (pin 14) to be used as inputs
+                              // note there is a crystal attached to these pins on the 
+                              // brainboard
+#pragma config MCLRE = OFF
+#pragma config LVP = OFF
+// #pragma config lines must come before #include "sumovore.h" as sumovore.h redefines OFF!!!
+
+#include <xc.h>
+#include <stdio.h>
+#include <reset.h>
+#include "..\Common\osc.h"
+#include "sumovore.h"
+#include "hal.h"
+#include "adc_scan.h"
+#include "instrument.h"
+#include "uart_tx.h"
+#include "telemetry.h"
+#include "led_code.h"
+#include "persist.h"
+#include "eeprom.h"
+#include "sched.h"
+
+
+void openPORTCforPWM(void);
+void openPORTCforUSART(void); 
+void openPORTA(void);
+void openPORTB(void);
+void openPORTD(void);
+void openPORTE(void);
+
+void reset_codes(void);
+void PORtask(void);
+void BORtask(void);
+void RESETtask(void);
+void WDTtask(void);
+void STKFULtask(void);
+void openLVD(void);
+void gtrap(unsigned char code);
+void led_code_wait(void);
+void warm_start(unsigned char cause, unsigned char code);
+
+#define LV_BRAKE_MS  300u   // LVtrap() brake time
+
+
+
+void initialization(void)
+{
+    SeeLine.B = 0;          // rev. April 3, 2014 for XC8
+    RCONbits.IPEN = 1;      // rev. April 30, 2010
+    INTCONbits.GIEH = 0;    // rev. April 30, 2010
+    INTCONbits.GIEL = 0;    // rev. April 30, 2010
+    
+    set_osc_32MHz();  // to change the internal oscillator frequency (see osc.h osc.c)
+    openPORTCforUSART();
+
+    OpenUSART( USART_TX_INT_OFF & USART_RX_INT_OFF & USART_ASYNCH_MODE & USART_EIGHT_BIT & USART_CONT_RX & USART_BRGH_HIGH,
+             16 );            // for 19200 bit per second
+                               // (32000000/115200/16)-1 = 16
+                  // actual buad rate is 32000000/(16*(16+1)) = 117647 baud (note a 2% error in frequency)
+      // see http://en.wikibooks.org/wiki/Serial_Programming/Typical_RS232_Hardware_Configuration#Oscillator_.26_Magic_Quartz_Crystal_Values
+#if defined(TELEMETRY) || defined(RECORD)
+    BAUDCONbits.BRG16 = 1;   // rev. Oct. 17, 2026 telemetry (and the recorder) need a faster link:
+    SPBRGH = 0;              //   16 bit BRG with BRGH: 32000000/(4*(15+1)) = 500000 baud (exact)
+    SPBRG = 15;
+#endif
+
+
+    openPORTD(); 
+    PORTD = 0;  // TURN ALL LED'S OFF 
+    
+    reset_codes();   // determine and display code for cause of MCU reset. 
+
+    openPORTCforPWM();
+
+    openPORTA();
+    openPORTB();    
+    openPORTE();
+   
+     
+    openLVD(); 
+    
+    
+
+    OpenADC(ADC_FOSC_64 & ADC_RIGHT_JUST & ADC_20_TAD , ADC_CH0 & ADC_INT_ON & ADC_VREFPLUS_VDD & ADC_VREFMINUS_VSS, AN0_AN7);
+// AN0-AN7 is defined in sumovore.h the others are defined in adc.h (C18 library) 
+// rev. Oct. 17, 2026 AN0_AN7 instead of AN0_AN4 for the battery on AN7 (battery.h).
+//   RE0 and RE1 (AN5, AN6) stay motor direction outputs, written through LATE.
+// rev. Oct. 17, 2026 TAD = 64 Tosc = 2 us and 20 TAD acquisition: one conversion
+//   takes (20+11)*2 = 62 us, a five sensor frame 310 us (about 3200 frames/s).
+//   The ADC interrupt now runs the scan round robin (adc_scan.c); the slower
+//   conversion keeps the share of CPU time spent in that ISR to about 20%.
+    IPR1bits.ADIP = 0;      // ADC is a low priority interrupt (HLVD stays high)
+    INTCONbits.GIEL = 1;    // enable low priority interrupts
+    adc_scan_start();
+
+    RmotorGoFwd = NO;  // NO is defined as 0b0 in sumovore.h
+    RmotorGoFwdCmp = NO;
+    LmotorGoFwd = NO;
+    LmotorGoFwdCmp = NO;
+//  PWMperiod = [(period)+1]x 4 x Tosc x TMR2
+//  period	Tosc    	TMR2Pre		pwm_period		freq
+//  255	    3.13E-08	16  		5.12E-04		1.95E+03
+
+    OpenTimer2(TIMER_INT_OFF & T2_PS_1_16 & T2_POST_1_1);  // TMR2 prescale is 16
+    OpenPWM1(199);           // TPWM = (199+1)*4*(31.25 ns)*16
+                             //      = 0.400 ms   or 2500 Hz
+    OpenPWM2(199);
+    SetDCPWM1(0);            // TDC  = 64*(31.25 ns)*16
+                             //      = 0.032 ms
+                             //      = 0% * TPWM  (800 will give 100%)
+    SetDCPWM2(0);
+    threshold = THRESHOLD_DEFAULT; 
+
+    OpenTimer0(TIMER_INT_ON & T0_8BIT & T0_SOURCE_INT & T0_PS_1_32);
+                             // scheduler tick (see sched.h): Fosc/4 = 8 MHz / 32 = 250 kHz
+                             // overflows every 256 counts = 1.024 ms, never reloaded
+    INTCON2bits.TMR0IP = 0;  // low priority, like the ADC
+
+    OpenTimer1(TIMER_INT_OFF & T1_16BIT_RW & T1_SOURCE_INT & T1_PS_1_1 & T1_OSC1EN_OFF & T1_SYNC_EXT_OFF);
+                             // free running cycle counter for hal_cycles(), no interrupt
+    instrument_init();
+
+    IPR1bits.TXIP = 0;       // USART transmit is a low priority interrupt, it is
+    uart_tx_start();         //   enabled by putch() whenever there is text to send
+
+}
+
+//***********************************************************************************
+//                          openPORTCforUSART()
+//***********************************************************************************
+void openPORTCforUSART(void)
+{
+  TRISCbits.TRISC6 = 0;  // set TX (RC6) as output 
+  TRISCbits.TRISC7 = 1;  // and RX (RC7) as input
+}
+
+//***********************************************************************************
+//                          openPORTCforPWM()
+//***********************************************************************************
+void openPORTCforPWM(void)
+{
+    TRISCbits.TRISC0 = 0; // Direction Left M
+    TRISCbits.TRISC1 = 0; // Enable Left M
+    TRISCbits.TRISC2 = 0; // Enable Right M 
+    TRISCbits.TRISC3 = 0; // I2C SCL
+    TRISCbits.TRISC4 = 0; // I2C SDA
+    TRISCbits.TRISC5 = 0; // Direction Right M
+    // TRISC6 and TRISC 7 initialized in openPORTCforUSART()
+}
+
+//***********************************************************************************
+//                          openPORTA()
+//***********************************************************************************
+void openPORTA(void)
+{
+    TRISA = 0B11101111; // RA0/AN0, RA1/AN1, RA2/AN2, RA3/AN3, RA5/AN4 SET AS INPUTS
+                        // RA4 not used set as output
+                        // bits RA6 and RA7 are left as inputs (crystal still attached 
+                        //  on sumovore)
+}
+
+//***********************************************************************************
+//                          openPORTB()
+//***********************************************************************************
+void openPORTB(void)
+{
+    TRISB = 0B11000000; // PORTB mostly not used
+                        // reserve pins 39 (RB6/PGC) and 40 (RB7/PGD)
+                        // as inputs to avoid conflict if ISP and PICkit2
+}
+
+//***********************************************************************************
+//                          openPORTD()
+//***********************************************************************************
+void openPORTD(void)
+{
+    TRISD = 0b01100000; // RD7 not connected
+    // RD6 is IR Right, RD5 is IR Left, RD4 is LED5, RD3 is LED4
+    // RD2 is LED3, RD1 is LED2 and RD0 is LED1
+}
+
+//***********************************************************************************
+//                          openPORTE()
+//***********************************************************************************
+void openPORTE(void)
+{
+    TRISE = 0b100; // E0 and E1 outputs, used for motor direction and
+                   // dynamic braking
+                   // rev. Oct. 17, 2026 E2 (AN7) is an input, the battery
+                   // voltage through a divider (battery.h)
+}
+
+
+
+// ****************************************************************
+//                 HAL functions (see hal.h)
+// ****************************************************************
+unsigned int hal_adc_convert(unsigned char channel)
+{
+    SetChanADC( channel );
+    ConvertADC();
+    while( BusyADC() );
+
+    return ReadADC();    
+}
+
+void hal_adc_start(unsigned char channel)
+{
+    SetChanADC( channel );
+    ConvertADC();            // GO is held off by the hardware for the acquisition time
+}
+
+unsigned int hal_adc_result(void)
+{
+    return (unsigned int) ReadADC();
+}
+
+void hal_set_pwm(enum motor_selection the_motor, unsigned int duty_cycle)
+{
+    if (the_motor == left) SetDCPWM2( duty_cycle );  // CCP2 (RC1) enables the left motor
+    else SetDCPWM1( duty_cycle );                     // CCP1 (RC2) enables the right motor
+}
+
+void hal_set_direction(enum motor_selection the_motor, unsigned char fwd, unsigned char fwd_cmp)
+{
+    if (the_motor == left)
+    {
+        LmotorGoFwd = fwd;
+        LmotorGoFwdCmp = fwd_cmp;
+    }
+    else
+    {
+        RmotorGoFwd = fwd;
+        RmotorGoFwdCmp = fwd_cmp;
+    }
+}
+
+void hal_set_leds(unsigned char pattern)
+{
+    set_all_LEDs(pattern);
+}
+
+unsigned char hal_uart_tx_ready(void)
+{
+    return PIR1bits.TXIF;    // TXREG empty
+}
+
+void hal_uart_write(unsigned char c)
+{
+    TXREG = c;
+}
+
+void hal_uart_tx_irq(unsigned char on)
+{
+    PIE1bits.TXIE = on;
+}
+
+unsigned char hal_tick_phase(void)
+{
+    return TMR0L;
+}
+
+// an ISR reading Timer1 between the two byte reads would latch a later
+// TMR1H, so the low priority one waits; GIEL is put back as it was, as
+// it is clear when this is called from the ISR itself
+unsigned int hal_cycles(void)
+{
+    unsigned int t;
+    unsigned char giel = INTCONbits.GIEL;
+
+    INTCONbits.GIEL = 0;
+    t = ReadTimer1();        // reads TMR1L first, TMR1H is latched with it (RD16)
+    INTCONbits.GIEL = giel;
+    return t;
+}
+
+void hal_idle(void)
+{
+                // nothing to do, the interrupts keep running while sched_run() waits
+}
+
+unsigned char hal_eeprom_read(unsigned char addr)
+{
+    return Read_b_eep( addr );   // from the peripheral library
+}
+
+// unlike Write_b_eep() this does not wait for the write to finish, eeprom_task()
+// polls hal_eeprom_busy() instead
+// GIEH is put back as it was: gtrap() writes with interrupts still off
+// (reset_codes() runs before openLVD())
+void hal_eeprom_write(unsigned char addr, unsigned char data)
+{
+    unsigned char gieh = INTCONbits.GIEH;
+
+    EEADRH = 0;
+    EEADR = addr;
+    EEDATA = data;
+    EECON1bits.EEPGD = 0;        // data EEPROM, not flash
+    EECON1bits.CFGS = 0;
+    EECON1bits.WREN = 1;
+    INTCONbits.GIEH = 0;         // the unlock sequence must not be interrupted
+    EECON2 = 0x55;
+    EECON2 = 0xAA;
+    EECON1bits.WR = 1;
+    INTCONbits.GIEH = gieh;
+}
+
+unsigned char hal_eeprom_busy(void)
+{
+    if ( EECON1bits.WR ) return 1;
+    EECON1bits.WREN = 0;         // no stray writes once it is done
+    return 0;
+}
+
+unsigned char hal_ir_detect(void)
+{
+    return (unsigned char)( (LeftIR ? 1u : 0u) | (RightIR ? 2u : 0u) );   // see sumovore.h
+}
+// ****************************************************************
+
+
+// ****************************************************************
+// determine and display code for cause of MCU reset. 
+// LED
+// 3  4  5
+// 0  0  0  Power on Reset  <POR>       This is the normal result of of flicking toggling the power switch
+// 0  0  1  Brown Out Reset   <BOR>     PIC detected a voltage below about 4.6 volts that did not return above 4.6 volts for more than 200 micro seconds
+// 0  1  0  Low Voltage Detect   <LVD>  PIC detected a voltage below 4.59 volts (actually not a reset but an interrupt)
+// 0  1  1  <not defined> should not get this
+// 1  0  0  WatchDog Timer reset  <WDT> These resets have been disabled 
+//                                              in the #pragma config WDT = OFF directive (near top of this file) 
+//                                              this code should not occure unless OFF is changed back to ON
+// 1  0  1  Stack Overflow   <SCKFUL>   This is usually an indication of unitended recursion (program bug)
+// 1  1  1  RESET task <reset>  (say a software reset -- this one has not been tested)
+//
+// LED 1 and 2 flash alternetly
+// rev. Oct. 17, 2026 the codes are shown by led_code.c. Define FAST_START (on the compiler
+//   command line, as TELEMETRY) to skip the 2 s POR pause and to run on after a BOR:
+//   the code is shown for LED_CODE_SHOW_TICKS while the control loop starts at once,
+//   so the robot moves within a few ms of a battery swap or a brown out.
+// rev. Oct. 17, 2026 with SUPERVISOR every reset is counted and logged (persist.h) and the
+//   ones after the POR go on where the robot was if the warm restart state is good
+//   (warm_start()), otherwise they trap as before.
+
+void reset_codes(void)
+{
+#ifdef SUPERVISOR
+    if( isPOR() ) persist_reset(reset_por);
+    else if( isBOR() ) warm_start(reset_bor, LED_CODE_BOR);
+    else if( isWDTTO() ) warm_start(reset_wdt, LED_CODE_WDT);
+    else if( STKPTRbits.STKFUL ) warm_start(reset_stkful, LED_CODE_STKFUL);
+    else warm_start(reset_other, LED_CODE_RESET);
+    if( led_code_showing ) return;  // warm, else the code for the cause as without SUPERVISOR
+#endif
+    if( isPOR() ) PORtask();        // rev. April 30, 2010 
+                                    //   Note that isPOR() is described on Page 145 of the MPlab C18 Library manual
+                                    // This indicates power dropped to zero (e.g. power switch toggled)
+    else if (isBOR() ) BORtask();   // this indicates a reset has occured due to low voltage for more than 200 micro seconds
+                                    //   Note that isBOR() is described on page 144 of the MPlab C18 Library manual
+    else if(isWDTTO() ) WDTtask();  // This indicates the watchdog timer has timed out and caused a reset
+                                    //   Note that using it requires careful program design that is beyond the scope of apsc1299.
+                                    //         isWDTTO() is descriped on page 145 of the MPlab C18 Library manual
+                                    //
+    else if(STKPTRbits.STKFUL) STKFULtask(); // The PIC has a 32 level hardware stack. 
+                                             //  Once the limit is exceded a reset should occur. Typically caused by unitended
+                                             //  recursion.
+
+    else RESETtask();              // This never comes up but it would indicate a software reset
+}
+
+#ifdef SUPERVISOR
+// **warm_start()**
+// rev. Oct. 17, 2026 counts and logs a reset other than POR. With good warm restart state
+//   the code is shown in the background, main() puts the state back (persist_resume())
+//   and the robot drives on. Otherwise nothing is shown and reset_codes() traps as before;
+//   no CLRWDT() may come before that, it would clear the WDT time out flag.
+void warm_start(unsigned char cause, unsigned char code)
+{
+    if( !persist_reset(cause) ) return;
+    StatusReset();       // sets flags /POR and /BOR, so the next BOR shows as one
+    STKPTRbits.STKFUL = 0;
+    printf("<warm %u>", cause);
+    led_code_show(code, LED_CODE_SHOW_TICKS);
+}
+#endif
+// *****************************************************************
+
+// **PORtask()**
+// control comes here if the power switch is toggled on and the PIC supply voltage is normal
+//   If a <POR> is indicated at any other time it probably indicates an open circuit occured.
+//   An open circuit could be caused by that a battery out of possition, the power switch or some loose connection.
+// Unlike the other reset events control stays in this function for only a couple of seconds
+
+void PORtask(void)  // rev. June 18, 2010
+{
+    StatusReset();       // sets flags /POR and /BOR see page 146 of the MPlab C18 Library manual
+                         
+    printf("<POR>");
+    led_code_show(LED_CODE_POR, LED_CODE_SHOW_TICKS);   // flash LEDs 1 and 2 alternately for a couple of seconds
+#ifndef FAST_START
+    led_code_wait();     // rev. Oct. 17, 2026 and stay here until the code is over (with FAST_START
+                         //   set_leds() runs it on in the background)
+#endif
+}    
+
+// ** BORtask()**
+// Control comes here only if a Brown Out Reset has occured since the last Power On Reset
+//  Note that a brown out reset occurs if the supply voltage drops below 4.36 volts and 
+//     does not return above 4.6 volts for more than 200 micro seconds (200 micro seconds is the
+//     minimum specified in the datasheet and the exact time requried to trigger the reset varies from PIC to PIC). 
+// The PIC is held in reset until the voltage is again above 4.6 volts (actual voltage can varry between the limits of 4.36 to 4.82). 
+// No code is executed while the PIC is held in reset.
+//  Unlike the POR the BOR is not a normal condition. 
+//  This function indicates the BOR code and gets trapped in an endless loop since all values stored 
+//  in volatile memory are possibly unreliable.
+//  Repeated frequent BOR's indicate low batteries but one should check for a misaligned battery and check the battery voltage.
+//  An individual single BOR could possibly be the result of a battery shifting in the holder.
+void BORtask(void)  // rev. June 18, 2010
+{
+    StatusReset();       // sets flags /POR and /BOR
+                         //  comment corrected Feb. 25, 2011
+    printf("<BOR>"); 
+#ifdef FAST_START
+    led_code_show(LED_CODE_BOR, LED_CODE_SHOW_TICKS);  // rev. Oct. 17, 2026 RAM is initialized again by
+                                                       //   the C startup code, so run on after a BOR
+#else
+    gtrap(LED_CODE_BOR);    // trap code here until POR
+#endif
+}
+
+// ** WDTtask()**
+// Control comes here only if a Watchdog timer time out occured which results in a reset.
+// This feature of the MCU can be used to detect improper program execution that could be caused by a 
+//  programming bug or some unknown cause. This feature is disabled at the top of this file but the code remains in case 
+// someone wants to try it out. Also, it is enabled for the diagnostic program used for testing the robots (that program
+// makes use of the same version of sumovore.c as the simple curve follower project except that the watchdog timer is enabled
+// with #pragma config WDT = ON in the diagnostic project).
+// Using the watchdog timer is beyond the scope of APSC1299.
+void WDTtask(void)  // rev. April 30, 2010
+{
+    printf("<WDT TO>");
+    gtrap(LED_CODE_WDT);    // trap code here until POR
+}
+
+// **STKFULtask()**
+// The PIC has a 32 level hardware stack. The C compiler sets up this stack for
+//  use in fucntion calls. Normally 32 levels is more than sufficient for our PIC
+//  programs and this reset is probably an indication of unintended recursion (this
+//  has been the case in all instances Dan is aware of since we enabled this in 
+//  2010. It is just possible that someone could use so many levels of function calls
+//  that the PIC's limit would be exceeded and this error would occur. Whatever the cause
+//  once the limit is exceded a reset should occur.
+void STKFULtask(void)    // rev. April 30, 2010
+{
+                           // An error on the hardware stack
+    STKPTRbits.STKFUL = 0; //  caused a reset!
+    printf("<STKFUL>");    //  continue 
+    gtrap(LED_CODE_STKFUL);    // trap code here until POR    
+}    
+
+// **RESETtask()**
+// The PIC does have a software reset instruction. It is not expected to be used in these programs.
+// This function would indicate if a software reset did occur.
+void RESETtask(void)    // rev. April 30, 2010
+{
+
+    printf(" <reset> ");     
+    gtrap(LED_CODE_RESET);    // trap code here until POR
+}   
+
+// **openLVD()**
+// this function sets up the low voltage
+//  detect feature of the PIC 
+//   sets HLVDIP to a high priority interrupt.
+//  The use of interrupts is beyond the scope of APSC1299.
+// Unlike any of the resets an interrupt results in an interrupt handling routine to be called. In general
+//   an interrupt handling routine executes quickly and returns. 
+// The interrupt routine for the LVD is defined in interrupts.c and it resets all the IO ports as inputs. 
+//    This will reduce the load on the batteries in an attempt to avoid a BOR. It also sets a flag lvd_flag.
+//    lvd_flag is checked in main() each time through the while loop to see if a low voltage has occured.
+//  
+void openLVD(void)
+{
+    RCONbits.IPEN = 1;
+    HLVDCONbits.HLVDEN = 1; // HLVDEN enabled
+
+    IPR2bits.HLVDIP = 1; // sets HLVD to high priority
+    HLVDCONbits.VDIRMAG = 0; // interrupt occures if voltage below
+                             //  trip point
+    HLVDCONbits.HLVDL3 = 1; // set to about 4.59 volts
+    HLVDCONbits.HLVDL2 = 1; 
+    HLVDCONbits.HLVDL1 = 1;
+    HLVDCONbits.HLVDL0 = 0;                                
+    PIR2bits.HLVDIF = 0; // ensure interrupt is clear                           
+    PIE2bits.HLVDIE = 1; // enables HLVD interrupt
+    INTCONbits.GIEH = 1; // globle enable of interrupts
+}    
+
+// **LVtrap()**
+// As described in the comments for openLVD() a low voltage detection causes an interrupt and the interrupt
+//   service routine sets a flag lvd_flag. This is detected in main() and once the lvd_flag is detected as set
+//   control comes here. This function has been setup much like the functions that handle different reset conditions.
+// rev. Oct. 17, 2026 a controlled stop: the motors are braked for LV_BRAKE_MS before
+//   the ports are set to inputs to reduce current requirements (this was done in the interrupt routine)
+// rev. Oct. 17, 2026 the brake is timed by Timer0 wraps, polled as in led_code_wait()
+void LVtrap(void)
+{
+    unsigned int ticks = (unsigned int)( LV_BRAKE_MS * 1000ul / SCHED_TICK_US );
+    unsigned char phase, last;
+
+    motors_brake_all();
+    OpenTimer0(TIMER_INT_OFF & T0_8BIT & T0_SOURCE_INT & T0_PS_1_32);
+    last = TMR0L;
+    while(ticks)
+    {
+        CLRWDT();
+        phase = TMR0L;
+        if (phase < last) ticks--;
+        last = phase;
+    }
+    TRISA = 0xff; // PORTs set to high impedence
+    TRISB = 0xff; // to reduce current requirements
+    TRISC = 0xff;
+    TRISD = 0xff;
+    TRISE = 0x07;
+    printf("\\<LVD>");
+    openPORTD();  // set as outputs for LED's
+    gtrap(LED_CODE_LVD);    // trap code here until POR  
+}
+
+// **gtrap**
+// called by reset functions (except POR) and by LVtrap(). Shows code (LED_CODE_BOR ...) with LED1 and
+// LED2 flashing alternetly forever.
+// Once here a reset is required to get out of this function.
+void gtrap(unsigned char code)
+{
+    while(eeprom_pending())   // rev. Oct. 17, 2026 finish any queued EEPROM writes (the reset
+    {                         //   log, a calibration), eeprom_task() does not run any more
+        CLRWDT();
+        eeprom_task();
+    }
+    led_code_show(code, LED_CODE_FOREVER);
+    led_code_wait();     // trap here
+}
+
+// **led_code_wait**
+// rev. Oct. 17, 2026 runs the code led_code_show() has set until it is over (never for
+//   LED_CODE_FOREVER). The scheduler is not running yet (PORtask()) or not any more
+//   (gtrap()), so Timer0 is set up as for the scheduler tick but polled: a wrap of
+//   TMR0L is a tick. Its flag is not used, the low priority ISR could clear it.
+void led_code_wait(void)
+{
+    unsigned char phase, last;
+
+    OpenTimer0(TIMER_INT_OFF & T0_8BIT & T0_SOURCE_INT & T0_PS_1_32);
+    last = TMR0L;
+    while(led_code_showing)
+    {
+        CLRWDT();
+        phase = TMR0L;
+        if (phase < last) led_code_update(1);
+        last = phase;
+    }
+}
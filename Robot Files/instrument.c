@@ -0,0 +1,112 @@
+// instrument.c
+//   Cycle count probes, see instrument.h
+//   Durations are taken modulo 65536 cycles (8.192 ms), longer ones wrap.
+//   rev. Oct. 17, 2026 sensor to motor latency histogram
+//   rev. Oct. 17, 2026 first version
+
+#include "instrument.h"
+
+#ifdef INSTRUMENT
+
+#include <stdio.h>
+#include "sumovore.h"
+#include "calibration.h"
+
+struct probe_stats
+{
+    unsigned int min;
+    unsigned int max;
+    unsigned long sum;
+    unsigned int count;
+};
+
+unsigned int probe_start[PROBES];
+unsigned int latency_start;
+unsigned long latency_hist[LATENCY_BUCKETS];
+unsigned int latency_max;
+
+static struct probe_stats stats[PROBES];
+static unsigned int overhead;   // cycles an empty PROBE_BEGIN / PROBE_END pair reads
+
+static const char * const probe_name[PROBES] =
+    { "tick", "check_sensors", "motor_control", "set_motor_speed", "set_leds" };
+
+static void clear_stats(void)
+{
+    unsigned char i;
+
+    for (i = 0; i < PROBES; i++)
+    {
+        stats[i].min = 0xffffu;
+        stats[i].max = 0u;
+        stats[i].sum = 0ul;
+        stats[i].count = 0u;
+    }
+}
+
+void instrument_init(void)
+{
+    unsigned int start;
+
+    start = hal_cycles();
+    overhead = hal_cycles() - start;
+    clear_stats();
+}
+
+void probe_record(unsigned char id, unsigned int cycles)
+{
+    struct probe_stats *s = &stats[id];
+
+    cycles = (cycles > overhead) ? cycles - overhead : 0u;
+    if (cycles < s->min) s->min = cycles;
+    if (cycles > s->max) s->max = cycles;
+    if (s->count != 0xffffu)
+    {
+        s->sum += cycles;
+        s->count++;
+    }
+}
+
+// one line per probe: name, min, max and mean instruction cycles and the
+// number of calls since the last report
+void instrument_report(void)
+{
+    unsigned char i;
+
+    for (i = 0; i < PROBES; i++)
+    {
+        if (stats[i].count == 0u) continue;
+        printf("%s %u %u %u %u\n\r", probe_name[i], stats[i].min, stats[i].max,
+               (unsigned int)(stats[i].sum / stats[i].count), stats[i].count);
+    }
+    clear_stats();
+}
+
+// after the PWM write of a control pass that acted on a new frame
+void latency_end(void)
+{
+    unsigned int cycles;
+    unsigned char bucket;
+
+    if (!line_frame_new || calibrating) return;
+    cycles = (hal_cycles() - latency_start) & 0xffffu;   // as on the PIC, for the simulator
+    if (cycles > latency_max) latency_max = cycles;
+    bucket = (unsigned char)(cycles >> LATENCY_BUCKET_SHIFT);
+    if (bucket >= LATENCY_BUCKETS) bucket = LATENCY_BUCKETS - 1u;
+    latency_hist[bucket]++;
+}
+
+// one line, see instrument.h; nothing before the first control pass
+void latency_report(void)
+{
+    unsigned char first, last, i;
+
+    for (first = 0; first < LATENCY_BUCKETS && latency_hist[first] == 0ul; first++);
+    if (first == LATENCY_BUCKETS) return;
+    for (last = LATENCY_BUCKETS - 1u; latency_hist[last] == 0ul; last--);
+    printf("latency %u %u", latency_max, first);
+    for (i = first; i <= last; i++) printf(" %lu", latency_hist[i]);
+    printf("\n\r");
+}
+
+#endif // INSTRUMENT
@@ -0,0 +1,69 @@
+// instrument.h
+//   Cycle count probes for the hot path.
+//   PROBE_BEGIN(id) / PROBE_END(id) read Timer1, which free runs at Fosc/4
+//   (one count per instruction cycle, 125 ns), and keep the min, max and
+//   mean number of cycles between them for each probe. instrument_report()
+//   prints the figures over the USART and starts a new measurement window.
+//   Without INSTRUMENT defined the macros are empty and instrument.c
+//   compiles to nothing, so the probes can stay in production code.
+//   rev. Oct. 17, 2026 sensor to motor latency: the ADC ISR stamps each frame
+//   with hal_cycles() as its first conversion starts, adc_scan_read() hands
+//   the stamp of the frame it copies to LATENCY_FRAME(), and LATENCY_END()
+//   after motor_output_update() has written the PWM duty puts the time
+//   since into latency_hist[], once for each new frame the control pass
+//   acts on (not while calibrating). The buckets are 2^LATENCY_BUCKET_SHIFT
+//   cycles wide, the last also takes everything longer. The histogram and
+//   latency_max count from power up; latency_report() prints them over the
+//   USART as the buckets from the first to the last one in use:
+//     latency <max> <first bucket> <count> <count> ...
+//   Latencies over 65535 cycles (8.192 ms) wrap, as the probes do. The
+//   simulator prints the same histogram in microseconds (make INSTRUMENT=1),
+//   without the time the PIC spends in check_sensors() and motor_control().
+//   rev. Oct. 17, 2026 first version
+
+#ifndef INSTRUMENT_H
+#define INSTRUMENT_H
+
+// #define INSTRUMENT    // uncomment (or define it on the compiler command line)
+                         //   to build the probes in
+
+enum probe_id { probe_tick, probe_check_sensors, probe_motor_control, probe_set_motor_speed,
+                probe_set_leds, PROBES };
+
+#ifdef INSTRUMENT
+
+#include "hal.h"
+
+extern unsigned int probe_start[PROBES];
+
+#define PROBE_BEGIN(id)   (probe_start[id] = hal_cycles())
+#define PROBE_END(id)     probe_record((id), hal_cycles() - probe_start[id])
+
+void instrument_init(void);    // measures the cost of an empty probe, called from initialization()
+void probe_record(unsigned char id, unsigned int cycles);
+void instrument_report(void);  // a scheduler task, see tasks.c
+
+#define LATENCY_BUCKET_SHIFT  10u   // 1024 cycles, 128 us per bucket
+#define LATENCY_BUCKETS       32u   // up to 4 ms, 128 bytes of RAM
+
+extern unsigned int latency_start;  // stamp of the frame the control pass reads
+extern unsigned long latency_hist[LATENCY_BUCKETS];
+extern unsigned int latency_max;    // cycles
+
+#define LATENCY_FRAME(stamp)  (latency_start = (stamp))
+#define LATENCY_END()         latency_end()
+
+void latency_end(void);
+void latency_report(void);     // a scheduler task, see tasks.c
+
+#else
+
+#define PROBE_BEGIN(id)
+#define PROBE_END(id)
+#define instrument_init()
+#define LATENCY_FRAME(stamp)
+#define LATENCY_END()
+
+#endif // INSTRUMENT
+
+#endif // INSTRUMENT_H
@@ -1,5 +1,8 @@
 #include <xc.h>
 #include "interrupts.h"
+#include "adc_scan.h"
+#include "sched.h"
+#include "uart_tx.h"
 
 
 
@@ -21,14 +24,13 @@ static unsigned char lvd_flag=0;
  // when reinitiallized by a reset of the PIC.
 
 
+// rev. Oct. 17, 2026 the ports are no longer set to inputs here: that let the
+//   motors coast on at whatever speed they had. LVtrap() (hal_pic18.c), called
+//   from main() within a tick, brakes them first and then sets the ports to
+//   inputs. The battery voltage tiers above this one are in battery.h.
 void interrupt high_isr(void)
 {
     PIR2bits.HLVDIF = 0; // ensure interupt is clear  
-    TRISA = 0xff; // PORTs set to high impedence
-    TRISB = 0xff; // to reduce current requirements
-    TRISC = 0xff;
-    TRISD = 0xff;
-    TRISE = 0x03;
     lvd_flag =1; // this sets the lvd flag
                  // lvd_flag_set() will return this
         // variables value so that the status of
@@ -40,6 +42,29 @@ void interrupt high_isr(void)
     HLVDCONbits.HLVDEN = 0; // HLVDEN disabled to reduce power
 }
 
+// rev. Oct. 17, 2026 low priority interrupts added.
+// The ADC interrupt keeps the five line sensors converting in the background,
+// see adc_scan.c, Timer0 is the scheduler tick, see sched.c, and the USART
+// transmit interrupt empties the printf() buffer, see uart_tx.c. The HLVD interrupt
+// above stays high priority so it can interrupt this one.
+void interrupt low_priority low_isr(void)
+{
+    if (INTCONbits.TMR0IF)
+    {
+        INTCONbits.TMR0IF = 0;
+        sched_tick_isr();
+    }
+    if (PIR1bits.ADIF)
+    {
+        PIR1bits.ADIF = 0;
+        adc_scan_isr();
+    }
+    if (PIE1bits.TXIE && PIR1bits.TXIF)   // TXIF stays set while TXREG is empty,
+    {                                     //   so only act on it when enabled
+        uart_tx_isr();
+    }
+}
+
 // the actual lvd_flag has scope only in this file.
 // This function allows other code to see the value of
 //  the flag but not to change it.
@@ -0,0 +1,183 @@
+// lap_map.c
+//   Segment map of the track and the speed profile taken from it, see lap_map.h
+//   rev. Oct. 17, 2026 lap_map_resume() clears the stripe holdoff
+//   rev. Oct. 17, 2026 ticks saturate; the odometer and turn follow motor_command[],
+//   so the map does not depend on the battery voltage
+//   rev. Oct. 17, 2026 first version
+
+#include <stdio.h>
+#include "sumovore.h"
+#include "lap_map.h"
+#include "eeprom.h"
+#include "telem_frame.h"
+#include "pattern_rules.h"
+
+#define LAP_MAP_MAGIC  0x1Au
+
+unsigned char lap_learning;
+enum lap_state lap_state;
+struct lap_segment lap_map[LAP_MAP_SEGMENTS];
+unsigned char lap_segments;
+unsigned int lap_count;
+unsigned int lap_ticks;
+
+static unsigned long odometer;       // duty ticks since the last stripe
+static unsigned int ticks;           // control ticks since the last stripe, stops at 0xffff
+static long turn1, turn2;            // left - right duty through two low pass stages,
+static int turn;                     //   scaled by 2^LAP_TURN_SHIFT to keep the fraction
+static unsigned char mark_frames;    // consecutive frames with LAP_MARK_SENSORS or more on
+static unsigned int seg_start;       // map units where the segment being recorded began
+static unsigned char pending;        // kind seen since pending_start
+static unsigned int pending_start;
+static unsigned char seg;            // segment being raced
+static unsigned int seg_end;         //   and where it ends
+static unsigned char image[EE_LAP_MAP_SIZE];
+
+static unsigned int position(void)
+{
+    unsigned long p = odometer >> LAP_ODO_SHIFT;
+
+    return (p > 0xffffu) ? 0xffffu : (unsigned int)p;
+}
+
+// record layout: magic, segment count, kind and length (low byte first) of
+// every segment, CRC-8 of everything before it
+static void save(void)
+{
+    unsigned char i, *p = image;
+
+    *p++ = LAP_MAP_MAGIC;
+    *p++ = lap_segments;
+    for (i = 0; i < LAP_MAP_SEGMENTS; i++)
+    {
+        *p++ = lap_map[i].kind;
+        *p++ = (unsigned char)lap_map[i].length;
+        *p++ = (unsigned char)(lap_map[i].length >> 8);
+    }
+    *p = telem_crc8(image, EE_LAP_MAP_SIZE - 1u);
+    eeprom_queue(EE_LAP_MAP, image, EE_LAP_MAP_SIZE);
+}
+
+void lap_map_init(void)
+{
+    unsigned char i, *p = image;
+
+    lap_state = lap_waiting;
+    lap_segments = 0;
+    lap_count = 0;
+    mark_frames = 0;
+    for (i = 0; i < EE_LAP_MAP_SIZE; i++) image[i] = eeprom_read((unsigned char)(EE_LAP_MAP + i));
+    if (image[0] != LAP_MAP_MAGIC || image[1] == 0u || image[1] > LAP_MAP_SEGMENTS
+        || telem_crc8(image, EE_LAP_MAP_SIZE - 1u) != image[EE_LAP_MAP_SIZE - 1u]) return;
+    p += 2;
+    for (i = 0; i < LAP_MAP_SEGMENTS; i++, p += 3)
+    {
+        lap_map[i].kind = p[0];
+        lap_map[i].length = p[1] | ((unsigned int)p[2] << 8);
+    }
+    lap_segments = image[1];
+}
+
+// the time since the last stripe is not known after a reset, so it counts
+// as long ago: LAP_MARK_HOLDOFF does not hide the next stripe
+void lap_map_resume(unsigned int count)
+{
+    lap_count = count;
+    ticks = 0xffffu;
+}
+
+// a new segment starts once the smoothed turn has shown another kind for
+// LAP_SEG_MIN; it starts where that kind was first seen. Shorter excursions
+// (weaving on a straight) stay part of the segment. Once the map is full the
+// last segment runs on to the stripe.
+static void record(unsigned char kind)
+{
+    unsigned int now = position();
+
+    if (kind == lap_map[lap_segments - 1u].kind) pending = kind;
+    else if (kind != pending)
+    {
+        pending = kind;
+        pending_start = now;
+    }
+    else if (now - pending_start >= LAP_SEG_MIN && lap_segments < LAP_MAP_SEGMENTS)
+    {
+        lap_map[lap_segments - 1u].length = pending_start - seg_start;
+        seg_start = pending_start;
+        lap_map[lap_segments].kind = kind;
+        lap_map[lap_segments].length = 0;
+        lap_segments++;
+    }
+}
+
+static void stripe(void)
+{
+    lap_count++;
+    lap_ticks = ticks;
+    if (lap_state == lap_recording)
+    {
+        lap_map[lap_segments - 1u].length = position() - seg_start;
+        save();
+        printf("lap map %u segments\n\r", lap_segments);
+    }
+    if (lap_state == lap_waiting && lap_segments == 0u)
+    {
+        lap_state = lap_recording;
+        lap_map[0].kind = seg_straight;   // the stripe is on a straight
+        lap_map[0].length = 0;
+        lap_segments = 1;
+        seg_start = 0;
+        pending = seg_straight;
+    }
+    else lap_state = lap_racing;
+    if (lap_count > 1u) printf("lap %u %u ticks\n\r", lap_count - 1u, lap_ticks);
+    odometer = 0;
+    ticks = 0;
+    seg = 0;
+    seg_end = lap_map[0].length;
+}
+
+void lap_map_update(void)
+{
+    int l = motor_command[left], r = motor_command[right], mean;
+    unsigned char kind, seen = SeeLine.B;
+
+    if (line_frame_new)
+    {
+        if (PAT_COUNT(seen) < LAP_MARK_SENSORS) mark_frames = 0;
+        else if (mark_frames < LAP_MARK_FRAMES && ++mark_frames == LAP_MARK_FRAMES
+                 && (ticks > LAP_MARK_HOLDOFF || lap_count == 0u)) stripe();
+    }
+
+    if (l == DUTY_BRAKE) l = 0;
+    if (r == DUTY_BRAKE) r = 0;
+    mean = (l + r) / 2;
+    if (mean > 0) odometer += (unsigned int)mean;
+    if (ticks != 0xffffu) ticks++;   // a long lap must not make the holdoff start over
+    turn1 += (l - r) - (turn1 >> LAP_TURN_SHIFT);
+    turn2 += (turn1 >> LAP_TURN_SHIFT) - (turn2 >> LAP_TURN_SHIFT);
+    turn = (int)(turn2 >> LAP_TURN_SHIFT);
+
+    if (lap_state == lap_recording)
+    {
+        kind = (turn > LAP_TURN_LIMIT) ? seg_right : (turn < -LAP_TURN_LIMIT) ? seg_left : seg_straight;
+        record(kind);
+    }
+    else if (lap_state == lap_racing)
+    {
+        while (seg < lap_segments && position() >= seg_end)
+        {
+            seg++;
+            if (seg < lap_segments) seg_end += lap_map[seg].length;
+        }
+    }
+}
+
+int lap_speed_trim(void)
+{
+    if (lap_state != lap_racing || seg >= lap_segments) return 0;
+    if (lap_map[seg].kind != seg_straight) return 0;
+    if (seg + 1u < lap_segments && lap_map[seg + 1u].kind != seg_straight
+        && seg_end - position() < LAP_BRAKE_AHEAD) return LAP_TRIM_BRAKE;
+    return LAP_TRIM_STRAIGHT;
+}
@@ -0,0 +1,74 @@
+// lap_map.h
+//   Lap learning: records the track as a list of straight and curve
+//   segments on one lap and uses it on the laps that follow to run faster
+//   on the straights and slow down before the curves.
+//
+//   Laps are counted at a start/finish stripe across the track (at least
+//   LAP_MARK_SENSORS sensors on the line for LAP_MARK_FRAMES frames; the
+//   line itself covers two at most). The lap after the first
+//   stripe is recorded; from the next stripe on the map is raced, and the
+//   position on it is reset at every stripe. Distance is estimated from the
+//   duty cycles (the mean forward duty summed every tick), so segment
+//   lengths stay the same when the robot runs faster. The duty is the one
+//   asked for before the battery scaling (motor_command[], battery.h), so
+//   they also stay the same as the pack drains. The map is saved in
+//   the data EEPROM and loaded at the next power up.
+//   Curves are found from the smoothed difference of the wheel duty cycles.
+//   simple_curves weaves too much on the straights for that, so the map
+//   should be recorded in pid_steering mode (it can be raced in either).
+//   rev. Oct. 17, 2026 lap_map_resume()
+//   rev. Oct. 17, 2026 distance from motor_command[], lap_ticks saturates
+//   rev. Oct. 17, 2026 first version
+
+#ifndef LAP_MAP_H
+#define LAP_MAP_H
+
+#define LAP_MAP_SEGMENTS   32u
+#define LAP_MARK_SENSORS   4       // sensors on the line at once that make a stripe, four
+                                   //   so a stripe crossed at an angle still counts
+#define LAP_MARK_FRAMES    3u      //   for this many frames
+#define LAP_MARK_HOLDOFF   500u    // ticks after a stripe before the next one counts, a
+                                   //   stripe crossed at an angle can come and go
+#define LAP_ODO_SHIFT      10      // map length units are 1024 duty ticks (about 1.3 ticks
+                                   //   at full speed)
+#define LAP_TURN_SHIFT     7       // the wheel duty difference goes through two low pass
+                                   //   stages of 128 ticks, which takes out the weaving
+                                   //   of the controller on a straight
+#define LAP_TURN_LIMIT     120     // smoothed |left - right duty| above this is a curve
+#define LAP_SEG_MIN        200u    // a change of kind must last this long (map units)
+                                   //   to start a new segment
+#define LAP_BRAKE_AHEAD    200u    // slow down this far before a curve (map units), on top
+                                   //   of the smoothing lag that already puts curves late
+#define LAP_TRIM_STRAIGHT  75      // duty added to both wheels on a known straight
+#define LAP_TRIM_BRAKE     (-150)  //   and before a known curve
+#define LAP_BASE_SPEED     medium  // PID base setting while lap_learning is on, leaves
+                                   //   room for LAP_TRIM_STRAIGHT
+
+enum segment_kind { seg_straight, seg_left, seg_right };
+
+struct lap_segment
+{
+    unsigned char kind;        // enum segment_kind
+    unsigned int length;       // map units
+};
+
+enum lap_state { lap_waiting, lap_recording, lap_racing };
+
+extern unsigned char lap_learning;       // set from main.c to turn lap learning on
+extern enum lap_state lap_state;
+extern struct lap_segment lap_map[LAP_MAP_SEGMENTS];
+extern unsigned char lap_segments;       // segments in lap_map[]
+extern unsigned int lap_count;           // stripes crossed
+extern unsigned int lap_ticks;           // ticks taken by the last complete lap, 65535 for
+                                         //   65535 or more (about 67 s)
+
+#define EE_LAP_MAP_SIZE    (2u + 3u * LAP_MAP_SEGMENTS + 1u)
+
+void lap_map_init(void);       // loads a map saved by an earlier run
+void lap_map_resume(unsigned int count);
+                 // after a warm restart (persist.h): count stripes crossed so far,
+                 // and the next stripe counts at once (its lap_ticks reads 65535)
+void lap_map_update(void);     // every control tick, after check_sensors()
+int lap_speed_trim(void);      // duty to add to both wheels, 0 without a map
+
+#endif // LAP_MAP_H
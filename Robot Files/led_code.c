@@ -0,0 +1,46 @@
+// led_code.c
+//   Status and error codes on the LEDs, see led_code.h
+//   rev. Oct. 17, 2026 first version
+
+#include "hal.h"
+#include "led_code.h"
+
+unsigned char led_code_showing;
+
+static unsigned char code;        // LED3 ... LED5, bits 2 to 4 as for hal_set_leds()
+static unsigned int remaining;    // ticks still to show it for, unless forever
+static unsigned char forever;
+static unsigned char phase;       // ticks into the current half of the flash
+static unsigned char led2;        // 1 while LED2 has the flash
+
+void led_code_show(unsigned char new_code, unsigned int ticks)
+{
+    code = new_code & 0x1cu;
+    remaining = ticks;
+    forever = ( ticks == LED_CODE_FOREVER );
+    phase = 0;
+    led2 = 0;
+    led_code_showing = 1;
+    hal_set_leds( (unsigned char)( code | 0x01u ) );
+}
+
+void led_code_update(unsigned char ticks)
+{
+    if ( !led_code_showing ) return;
+    if ( !forever )
+    {
+        if ( remaining <= ticks )
+        {
+            led_code_showing = 0;   // the caller puts its own pattern back
+            return;
+        }
+        remaining -= ticks;
+    }
+    phase += ticks;
+    if ( phase >= LED_CODE_HALF_TICKS )
+    {
+        phase -= LED_CODE_HALF_TICKS;
+        led2 ^= 1u;
+    }
+    hal_set_leds( (unsigned char)( code | ( led2 ? 0x02u : 0x01u ) ) );
+}
@@ -0,0 +1,37 @@
+// led_code.h
+//   Status and error codes on the five LEDs, shown without busy waiting.
+//   A code is a steady pattern on LED3 ... LED5 (the reset cause table above
+//   reset_codes() in hal_pic18.c) with LED1 and LED2 flashing alternately
+//   beside it, as the old counting loops showed them. led_code_update()
+//   moves the flash on by the scheduler ticks gone by since its last call:
+//     set_leds() calls it every LED_PERIOD_TICKS and shows the sensors again
+//                once the code has run out, so a code can be shown while the
+//                robot runs (the reset cause with FAST_START, see hal_pic18.c)
+//     led_code_wait() in hal_pic18.c calls it on every Timer0 overflow where
+//                the scheduler is not running: the POR pause and gtrap()
+//   rev. Oct. 17, 2026 first version
+
+#ifndef LED_CODE_H
+#define LED_CODE_H
+
+#define LED_CODE_HALF_TICKS  98u     // LED1 on, then LED2 on, about 0.1 s each
+#define LED_CODE_SHOW_TICKS  1953u   // about 2 s, as long as the old POR pause
+#define LED_CODE_FOREVER     0u      // for led_code_show(): until the next reset
+
+                                 // LED  3 4 5
+#define LED_CODE_POR     0x00u   //      0 0 0  power on reset
+#define LED_CODE_BOR     0x10u   //      0 0 1  brown out reset
+#define LED_CODE_LVD     0x08u   //      0 1 0  low voltage detect (HLVD)
+#define LED_CODE_WDT     0x04u   //      1 0 0  watchdog timer reset
+#define LED_CODE_STKFUL  0x14u   //      1 0 1  stack overflow
+#define LED_CODE_RESET   0x1cu   //      1 1 1  software reset
+
+extern unsigned char led_code_showing;   // 1 while a code has the LEDs
+
+void led_code_show(unsigned char code, unsigned int ticks);
+                 // shows code (LED_CODE_POR ...) for ticks scheduler ticks,
+                 // starting with LED1 on
+void led_code_update(unsigned char ticks);
+                 // ticks have gone by: flashes LED1/LED2 and ends the code on time
+
+#endif // LED_CODE_H
@@ -0,0 +1,66 @@
+// line_feature.c
+//   Crossing and gap classifier, see line_feature.h
+//   rev. Oct. 17, 2026 first version
+
+#include "line_feature.h"
+#include "pattern_rules.h"
+
+#define WIDE(p)     (PAT_COUNT(p) >= 3 || (PAT_COUNT(p) == 2 && !((p) & ((p) >> 1))))
+#define NARROW(p)   ((p) && !WIDE(p))
+#define CENTRED(p)  ((p) == 0x04u || (p) == 0x0cu || (p) == 0x06u)
+
+enum line_feature line_feature;
+unsigned int crossings_seen;
+unsigned int gaps_seen;
+
+static unsigned char narrow_ticks;    // a narrow pattern this long, up to FEATURE_ARM_TICKS
+static unsigned char centred_ticks;   // on the centre sensors this long, up to GAP_ARM_TICKS
+static unsigned char feature_ticks;   // time in the current feature
+
+enum line_feature line_feature_update(unsigned char pattern)
+{
+    if (line_feature != feature_none)
+    {
+        feature_ticks++;
+        if (NARROW(pattern) && (line_feature == feature_gap || feature_ticks >= CROSS_MIN_TICKS))
+        {
+            line_feature = feature_none;     // through it, back on the line
+            narrow_ticks = 0;
+            centred_ticks = 0;
+            return line_feature;
+        }
+        if (line_feature == feature_gap && pattern)
+        {
+            line_feature = feature_crossing; // a gap before a crossing
+            crossings_seen++;
+            feature_ticks = 0;
+            return line_feature;
+        }
+        if (feature_ticks >= (line_feature == feature_gap ? GAP_MAX_TICKS : CROSS_MAX_TICKS))
+        {
+            line_feature = feature_none;     // the line did not come back where expected:
+            narrow_ticks = 0;                //   over to the pattern rules (or line_recovery.h)
+            centred_ticks = 0;
+        }
+        return line_feature;
+    }
+
+    if (NARROW(pattern))
+    {
+        if (narrow_ticks < FEATURE_ARM_TICKS) narrow_ticks++;
+        if (!CENTRED(pattern)) centred_ticks = 0;
+        else if (centred_ticks < GAP_ARM_TICKS) centred_ticks++;
+        return line_feature;
+    }
+    if (pattern ? narrow_ticks >= FEATURE_ARM_TICKS : centred_ticks >= GAP_ARM_TICKS)
+    {
+        line_feature = pattern ? feature_crossing : feature_gap;
+        if (pattern) crossings_seen++;
+        else gaps_seen++;
+        feature_ticks = 0;
+        return line_feature;
+    }
+    narrow_ticks = 0;
+    centred_ticks = 0;
+    return line_feature;
+}
@@ -0,0 +1,41 @@
+// line_feature.h
+//   Crossings, T-junctions and gaps in the line, told from the recent
+//   SeeLine history, so that motor_control() drives straight through them
+//   instead of steering after the extra line or stopping in the gap.
+//
+//   The line is "narrow" under one sensor or two neighbours. Then
+//     a wide pattern (three or more sensors, or two apart such as 0b10100)
+//       after FEATURE_ARM_TICKS of narrow ones is a crossing or T-junction:
+//       straight ahead until a narrow pattern is back after at least
+//       CROSS_MIN_TICKS, or for CROSS_MAX_TICKS at most
+//     no line at all right after GAP_ARM_TICKS under the centre sensors
+//       (0b00100, 0b01100 or 0b00110) is a gap in the line: straight ahead
+//       until the line comes back, for GAP_MAX_TICKS at most. A line lost
+//       over an outer sensor is an overshoot instead, for line_recovery.h.
+//   Straight ahead is both wheels at the same setting, with the PID (if on)
+//   left as it was.
+//   The start/finish stripe of lap_map.h is a crossing too, which is fine:
+//   lap_map_update() reads SeeLine itself.
+//   Times are in control ticks (about 1 ms).
+//   rev. Oct. 17, 2026 first version
+
+#ifndef LINE_FEATURE_H
+#define LINE_FEATURE_H
+
+#define FEATURE_ARM_TICKS  30u
+#define GAP_ARM_TICKS      3u     // debounce only
+#define CROSS_MIN_TICKS    10u
+#define CROSS_MAX_TICKS    150u
+#define GAP_MAX_TICKS      120u
+
+enum line_feature { feature_none, feature_crossing, feature_gap };
+
+extern enum line_feature line_feature;   // what is being driven through now
+extern unsigned int crossings_seen;      // counts, for the simulator summary
+extern unsigned int gaps_seen;
+
+enum line_feature line_feature_update(unsigned char pattern);
+                 // once per control tick with SeeLine.B, returns line_feature:
+                 // anything but feature_none means drive straight ahead
+
+#endif // LINE_FEATURE_H
@@ -0,0 +1,37 @@
+// line_position.c
+//   Weighted centroid line position, see line_position.h
+//   Integer only: at most 5 multiplies by a small constant and one long
+//   divide per frame.
+//   rev. Oct. 17, 2026 first version
+
+#include "line_position.h"
+
+int line_position;
+unsigned char line_found;
+
+void line_position_update(const unsigned int *reading)
+{
+    unsigned int low = 1023u, high = 0u, weight, total = 0u;
+    int moment = 0;
+    unsigned char i;
+
+    for (i = 0; i < LINE_SENSORS; i++)
+    {
+        if (reading[i] < low) low = reading[i];
+        if (reading[i] > high) high = reading[i];
+    }
+    if (high - low < LINE_MIN_CONTRAST)   // all floor (or all line): nothing to locate
+    {
+        line_found = 0;
+        return;
+    }
+
+    for (i = 0; i < LINE_SENSORS; i++)
+    {
+        weight = reading[i] - low;          // 0 to 1023
+        total += weight;                    // at most 5 * 1023, fits an unsigned int
+        moment += (int)weight * ((int)i - 2);   // sensor i sits (i-2) pitches from the centre
+    }
+    line_position = (int)(((long)moment * LINE_POS_PITCH) / (long)total);
+    line_found = 1;
+}
@@ -0,0 +1,26 @@
+// line_position.h
+//   Analog line position from the five raw reflective sensor readings.
+//   A weighted centroid in fixed point: each sensor is weighted by how far
+//   its reading is above the lowest reading of the frame, which gives the
+//   position of the line between sensors rather than the five coarse
+//   positions of SeeLine.
+//   rev. Oct. 17, 2026 first version
+
+#ifndef LINE_POSITION_H
+#define LINE_POSITION_H
+
+#include "sumovore.h"
+
+#define LINE_POS_PITCH     256     // line_position units per sensor spacing
+#define LINE_POS_MAX       (2 * LINE_POS_PITCH)   // line under the right (or left) sensor
+#define LINE_MIN_CONTRAST  100u    // highest minus lowest reading needed to trust a frame
+
+extern int line_position;          // -512 line under the left sensor, 0 under the centre
+                                   //  sensor, +512 under the right sensor
+extern unsigned char line_found;   // 1 when line_position comes from the latest frame,
+                                   // 0 when no line was seen (line_position keeps its last value)
+
+void line_position_update(const unsigned int *reading);
+                 // reading[LINE_SENSORS] as in line_adc[], called from check_sensors()
+
+#endif // LINE_POSITION_H
@@ -0,0 +1,48 @@
+// line_recovery.c
+//   Lost line recovery, see line_recovery.h
+//   rev. Oct. 17, 2026 first version
+
+#include "line_recovery.h"
+#include "line_position.h"
+
+unsigned int line_lost_ticks;
+unsigned char line_last_pattern;
+
+static struct wheel_command command;
+
+const struct wheel_command *line_recovery_update(unsigned char pattern)
+{
+    int c, level;
+
+    if (pattern)
+    {
+        line_last_pattern = pattern;
+        line_lost_ticks = 0;
+        return 0;
+    }
+    if (line_lost_ticks < 0xffffu) line_lost_ticks++;
+    if (!line_last_pattern || line_lost_ticks >= RECOVER_TIMEOUT)
+    {
+        command.left = PATTERN_BRAKE;
+        command.right = PATTERN_BRAKE;
+        return &command;
+    }
+
+    if (line_lost_ticks >= RECOVER_BACK)
+    {
+        command.left = rev_medium;
+        command.right = rev_medium;
+        return &command;
+    }
+    c = PAT_CENTROID(line_last_pattern);      // -4 (far left) ... +4 (far right)
+    if (line_lost_ticks >= RECOVER_HOLD)
+    {
+        level = (line_lost_ticks < RECOVER_PIVOT) ? 2 : (line_lost_ticks < RECOVER_REVERSE) ? 3 : 4;
+        if (c == 0) c = (line_position < 0) ? -1 : 1;
+        if (c < 0 && c > -level) c = -level;
+        if (c > 0 && c < level) c = level;
+    }
+    command.left = INNER_WHEEL(c);
+    command.right = INNER_WHEEL(-c);
+    return &command;
+}
@@ -0,0 +1,45 @@
+// line_recovery.h
+//   What to do when no sensor sees the line (SeeLine.B == 0). Instead of
+//   braking at once, the robot turns back toward the side it last saw the
+//   line on, harder the longer the line stays lost:
+//
+//     lost for          wheels (inner wheel on the last seen side)
+//     < RECOVER_HOLD    the command of the last pattern seen, so a momentary
+//                       overshoot or a gap in the line costs nothing
+//     < RECOVER_PIVOT   at least a pivot:  inner stop,     outer fast
+//     < RECOVER_REVERSE at least            inner rev_slow, outer fast
+//     < RECOVER_BACK    spin:               inner rev_fast, outer fast
+//     < RECOVER_TIMEOUT back up:            both rev_medium
+//     after that        brake, until the line is seen again
+//
+//   A spin only sweeps the sensors around the axle. A robot that crossed
+//   the line at a steep angle has carried on past it, out of reach, so
+//   the last try is to back up toward it.
+//   "At least": a pattern that already had the robot turning harder keeps
+//   that. The side is the sign of the last pattern's centroid
+//   (pattern_rules.h), or of line_position when that pattern was centred.
+//   Until the line has been seen once after reset the robot brakes, so it
+//   does not drive off when switched on away from the line.
+//   Times are in control ticks (CONTROL_PERIOD_TICKS, about 1 ms).
+//   rev. Oct. 17, 2026 first version
+
+#ifndef LINE_RECOVERY_H
+#define LINE_RECOVERY_H
+
+#include "pattern_rules.h"
+
+#define RECOVER_HOLD      25u
+#define RECOVER_PIVOT     100u
+#define RECOVER_REVERSE   250u
+#define RECOVER_BACK      800u
+#define RECOVER_TIMEOUT   1500u    // brake after this long without the line
+
+extern unsigned int line_lost_ticks;     // control ticks since the line was last seen
+extern unsigned char line_last_pattern;  // last non-zero SeeLine.B, 0 before the first
+
+const struct wheel_command *line_recovery_update(unsigned char pattern);
+                 // once per control tick with SeeLine.B. Returns 0 while the line is
+                 // seen, else the wheel command to use (PATTERN_BRAKE for both after
+                 // RECOVER_TIMEOUT)
+
+#endif // LINE_RECOVERY_H
@@ -3,9 +3,17 @@
 #include "sumovore.h"
 #include "motor_control.h"
 #include "interrupts.h"
+#include "sched.h"
+#include "tasks.h"
+#include "calibration.h"
+#include "lap_map.h"
+#include "record.h"
+#include "persist.h"
 
 
 // main acts as a cyclical task sequencer
+// rev. Oct. 17, 2026 the tasks now run at fixed rates from Timer0 ticks,
+//   see the task table in tasks.c and sched.c
 void main(void)
 {
    
@@ -19,16 +27,28 @@ void main(void)
 
 //  threshold = 450u; // to change from default value
                      // uncomment and change to any unsigned int <1024u -- most usually <512u
+//  control_mode = pid_steering;  // uncomment for PID steering from the analog line position
+                                  // (gains are in pid, see pid_steer.h)
+//  lap_learning = 1;  // uncomment to learn the track on the first lap after the
+                       // start/finish stripe and race it on the laps after that (lap_map.h)
+    record_start();      // with RECORD defined: the settings above and the data EEPROM
+                         // go to the flight recorder (record.h) ahead of the run
+    calibration_init();  // per-sensor thresholds from the EEPROM (threshold if there are none);
+                         // block both IR detectors at power up to run a calibration sweep,
+                         // see calibration.h
+    lap_map_init();      // a track map saved by an earlier run, if there is one
+    persist_resume();    // with SUPERVISOR, after a watchdog or brown out reset: the state
+                         // from before it, so the robot drives on (persist.h); it goes to
+                         // the flight recorder after record_start()'s records
 
     while(1)
     {
-        check_sensors();    // from sumovore.c
-        set_leds();         // function from sumovore.c
-	                    // each LED indicates a sensor
+        sched_run(tasks, TASKS);  // waits for the next tick then runs the tasks that are due:
+                            // check_sensors() and motor_control() every tick,
+                            // set_leds() at a sub-rate (each LED indicates a sensor
 	                    // value. If you need to use the LED's for
-	                    // a different purpose change this line
-	                    // and make your own LED setting function
-        motor_control();    // function from motor_control.c 
+	                    // a different purpose change its line in tasks.c
+	                    // and make your own LED setting function)
         ClrWdt();           // defined in <p18f4525.h>
         if(lvd_flag_set())  LVtrap();
     }
@@ -1,65 +1,108 @@
 #include "sumovore.h"
 #include "motor_control.h"
+#include "line_position.h"
+#include "pid_steer.h"
+#include "pattern_rules.h"
+#include "lap_map.h"
+#include "line_recovery.h"
+#include "line_feature.h"
+#include "obstacle.h"
 
-void follow_simple_curves(void);
-void spin_left(void);
-void turn_left(void);
-void straight_fwd(void);
-void turn_right(void);
-void spin_right(void);
+#define PID_BASE_SPEED  fast   // both wheels run at this setting when the line is centred
+
+enum control_mode control_mode = simple_curves;
+
+void follow_line_pid(int trim, unsigned char straight);
+void drive_command(const struct wheel_command *command, int trim);
+
+// rev. Oct. 17, 2026 every sensor pattern has a wheel command, built by the
+// compiler from the rules in pattern_rules.h. This replaces the switch and
+// follow_simple_curves(), which left the motors in their last state for any
+// pattern with more than one sensor on the line.
+const struct wheel_command pattern_commands[32] =
+{
+    PATTERN_RULE(0),  PATTERN_RULE(1),  PATTERN_RULE(2),  PATTERN_RULE(3),
+    PATTERN_RULE(4),  PATTERN_RULE(5),  PATTERN_RULE(6),  PATTERN_RULE(7),
+    PATTERN_RULE(8),  PATTERN_RULE(9),  PATTERN_RULE(10), PATTERN_RULE(11),
+    PATTERN_RULE(12), PATTERN_RULE(13), PATTERN_RULE(14), PATTERN_RULE(15),
+    PATTERN_RULE(16), PATTERN_RULE(17), PATTERN_RULE(18), PATTERN_RULE(19),
+    PATTERN_RULE(20), PATTERN_RULE(21), PATTERN_RULE(22), PATTERN_RULE(23),
+    PATTERN_RULE(24), PATTERN_RULE(25), PATTERN_RULE(26), PATTERN_RULE(27),
+    PATTERN_RULE(28), PATTERN_RULE(29), PATTERN_RULE(30), PATTERN_RULE(31)
+};
 
 void motor_control(void)
 {
-     // very simple motor control
-     switch(SeeLine.B)
+     const struct wheel_command *command;
+     enum line_feature feature;
+     int trim = 0, obstacle_trim = 0;
+
+     if ( lap_learning )
+     {
+        lap_map_update();            // rev. Oct. 17, 2026 faster on known straights,
+        trim = lap_speed_trim();     //   slower before known curves, see lap_map.h
+     }
+     command = line_recovery_update( SeeLine.B );   // rev. Oct. 17, 2026 no line: turn back
+                                                    //   toward it, see line_recovery.h
+     feature = line_feature_update( SeeLine.B );    // rev. Oct. 17, 2026 crossings and gaps
+                                                    //   both run every tick, even braked
+     if ( obstacle_action )          // rev. Oct. 17, 2026 something in front, see obstacle.h
+     {
+        if ( obstacle_action == obstacle_stop )
+        {
+            motors_brake_all();
+            return;
+        }
+        obstacle_trim = OBSTACLE_SLOW_TRIM;
+        trim += obstacle_trim;
+     }
+     if ( feature != feature_none )  // straight through, see line_feature.h
+     {
+        if ( control_mode == pid_steering ) follow_line_pid( trim, 1 );
+        else drive_command( &pattern_commands[ 0x04 ], trim );   // 0b00100, both fast
+        return;
+     }
+     if ( command )
+     {
+        drive_command( command, obstacle_trim );   // not the lap trim, the map is no guide here
+        return;
+     }
+     if ( control_mode == pid_steering )
      {
-        case 0b00100u:
-        case 0b00010u:
-        case 0b01000u:
-        case 0b00001u:
-        case 0b10000u:
-                       //no breaks all above readings end up here
-                       follow_simple_curves();
-                       break;
-        case 0b00000u:
-                        motors_brake_all();
-                       break;
-        default:       break;
-      } 
+        follow_line_pid( trim, 0 );
+        return;
+     }
+     // very simple motor control: one table lookup per sensor pattern
+     drive_command( &pattern_commands[ SeeLine.B ], trim );
 }
 
-void follow_simple_curves(void)
+// trim only goes on wheels that run forward
+void drive_command(const struct wheel_command *command, int trim)
 {
-     if ( SeeLine.b.Center ) straight_fwd();
-     else if (SeeLine.b.Left) spin_left();
-     else if (SeeLine.b.CntLeft) turn_left();
-     else if (SeeLine.b.CntRight) turn_right();
-    else if (SeeLine.b.Right) spin_right();
+     if ( command->left == PATTERN_BRAKE ) motors_brake_all();
+     else
+     {
+        set_motor_speed(left, (enum motor_speed_setting) command->left, command->left > stop ? trim : 0);
+        set_motor_speed(right, (enum motor_speed_setting) command->right, command->right > stop ? trim : 0);
+     }
 }
 
-void spin_left(void)
+// rev. Oct. 17, 2026 continuous steering from the analog line position.
+// The PID only runs when check_sensors() got a new frame so its I and D terms
+// see the frame period; in between the last wheel commands are repeated.
+// When the line is lost line_position keeps its last value, so the robot
+// keeps turning toward the side it was last seen on.
+// trim is added to both wheels (lap_map.h); with lap learning on the base
+// setting drops to LAP_BASE_SPEED so that a positive trim has room.
+// straight (through a crossing or gap, line_feature.h) drives both wheels at
+// the base setting and leaves the PID as it was.
+void follow_line_pid(int trim, unsigned char straight)
 {
-  set_motor_speed(left, rev_fast, 0); 
-  set_motor_speed(right, fast, 0); 
-}
+    static int steer;
+    enum motor_speed_setting base = lap_learning ? LAP_BASE_SPEED : PID_BASE_SPEED;
 
-void turn_left(void)
-{
-  set_motor_speed(left, stop, 0); 
-  set_motor_speed(right, fast, 0); 
-}
-void straight_fwd(void)
-{
-  set_motor_speed(left, fast, 0); 
-  set_motor_speed(right, fast, 0); 
-}
-void spin_right(void)
-{
-  set_motor_speed(left, fast, 0); 
-  set_motor_speed(right, rev_fast, 0); 
-}
-void turn_right(void)
-{
-  set_motor_speed(left, fast, 0); 
-  set_motor_speed(right, stop, 0); 
+    if ( straight ) steer = 0;
+    else if ( line_frame_new ) steer = pid_steer_update( line_position );
+    set_motor_speed(left, base, steer + trim);
+    set_motor_speed(right, base, -steer + trim);
 }
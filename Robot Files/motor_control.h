@@ -1 +1,6 @@
+enum control_mode { simple_curves, pid_steering };  // rev. Oct. 17, 2026
+
+extern enum control_mode control_mode;  // defn. is in motor_control.c, default simple_curves
+                                        // set to pid_steering in main.c for PID steering
+
 void motor_control(void);
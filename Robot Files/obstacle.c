@@ -0,0 +1,36 @@
+// obstacle.c
+//   Debounced IR obstacle events, see obstacle.h
+//   rev. Oct. 17, 2026 first version
+
+#include "hal.h"
+#include "obstacle.h"
+#include "record.h"
+
+unsigned char obstacle_seen;
+unsigned char obstacle_action;
+unsigned int obstacle_events;
+
+static unsigned char count[2];   // samples in a row that disagree with obstacle_seen
+
+void obstacle_task(void)
+{
+    unsigned char ir, seen, bit, i;
+
+    ir = hal_ir_detect();
+    seen = obstacle_seen;
+    for (i = 0, bit = 1u; i < 2u; i++, bit <<= 1)
+    {
+        if (((ir ^ seen) & bit) == 0u) count[i] = 0;
+        else if (++count[i] >= ((seen & bit) ? OBSTACLE_CLEAR_SAMPLES : OBSTACLE_ON_SAMPLES))
+        {
+            seen ^= bit;
+            count[i] = 0;
+        }
+    }
+    if (seen == obstacle_seen) return;   // no event, the usual case
+
+    obstacle_seen = seen;
+    obstacle_action = (seen == 3u) ? obstacle_stop : seen ? obstacle_slow : obstacle_none;
+    obstacle_events++;
+    record_obstacle();   // the control loop drives differently from here on
+}
@@ -0,0 +1,37 @@
+// obstacle.h
+//   Obstacles in front of the robot, from the two IR detectors (LeftIR and
+//   RightIR in sumovore.h, read through hal_ir_detect()).
+//   RD5 and RD6 have no interrupt on change (the PIC18F4525 has it on RB4 to
+//   RB7 only), so obstacle_task() samples them every OBSTACLE_PERIOD_TICKS
+//   (tasks.h).
+//   A detector counts as seeing an obstacle after OBSTACLE_ON_SAMPLES samples
+//   in a row say so and as clear again after OBSTACLE_CLEAR_SAMPLES, which
+//   rides out flicker from sunlight and the edge of the detector's range.
+//   Only a change of the debounced state is an event: it sets
+//     obstacle_action  obstacle_slow with one detector seeing it: both wheels
+//                      get OBSTACLE_SLOW_TRIM (as lap_map.h trims them), in
+//                      line recovery too (line_recovery.h)
+//                      obstacle_stop with both: the motors brake, while line
+//                      recovery and line_feature.h keep following SeeLine
+//   which motor_control() checks once per pass, a single byte test while
+//   nothing is in front. From the obstacle appearing to the motors braking
+//   takes at most OBSTACLE_PERIOD_TICKS * OBSTACLE_ON_SAMPLES + 1 ticks
+//   (about 13 ms), and the slew limit does not apply to a brake.
+//   rev. Oct. 17, 2026 first version
+
+#ifndef OBSTACLE_H
+#define OBSTACLE_H
+
+#define OBSTACLE_ON_SAMPLES     3u     // samples in a row to see an obstacle
+#define OBSTACLE_CLEAR_SAMPLES  25u    //   and to see it gone (about 0.1 s)
+#define OBSTACLE_SLOW_TRIM      (-300) // duty added to both forward wheels
+
+enum obstacle_action { obstacle_none, obstacle_slow, obstacle_stop };
+
+extern unsigned char obstacle_seen;    // debounced, bit 0 LeftIR, bit 1 RightIR
+extern unsigned char obstacle_action;  // enum obstacle_action
+extern unsigned int obstacle_events;   // changes of obstacle_seen since reset
+
+void obstacle_task(void);   // a scheduler task, see tasks.c
+
+#endif // OBSTACLE_H
@@ -0,0 +1,54 @@
+// pattern_rules.h
+//   Rules that turn a 5 bit sensor pattern (SeeLine.B) into a pair of wheel
+//   settings. They are constant expressions: motor_control.c expands
+//   PATTERN_RULE(0) ... PATTERN_RULE(31) into a 32 entry const table, so the
+//   compiler generates the table and nothing is evaluated at run time.
+//   rev. Oct. 17, 2026 note on rule 1 and line recovery
+//   rev. Oct. 17, 2026 first version
+//
+//   Rule 1: no sensor sees the line (0b00000)              -> brake
+//           (motor_control() only gets here through line_recovery.h, which
+//           first steers back toward the line and brakes when that times out)
+//   Rule 2: otherwise steer by the centroid of the sensors that see the line,
+//           in half sensor spacings from the centre (left -4 ... right +4,
+//           truncated toward 0):
+//
+//      centroid   left wheel   right wheel   e.g.
+//         -4      rev_fast     fast          0b10000  (spin_left)
+//         -3      rev_slow     fast          0b11000
+//         -2      stop         fast          0b01000  (turn_left), 0b11100
+//         -1      slow         fast          0b01100
+//          0      fast         fast          0b00100  (straight_fwd), 0b01110, 0b11111, 0b10001
+//         +1 ... +4 mirror image
+//
+//   The single sensor patterns give the same wheel settings as the old
+//   follow_simple_curves().
+
+#ifndef PATTERN_RULES_H
+#define PATTERN_RULES_H
+
+#include "sumovore.h"
+
+#define PATTERN_BRAKE  0xffu   // wheel setting that means motors_brake_all()
+
+struct wheel_command
+{
+    unsigned char left;    // enum motor_speed_setting or PATTERN_BRAKE
+    unsigned char right;
+};
+
+#define PAT_BIT(p, n)     (((p) >> (n)) & 1)
+#define PAT_COUNT(p)      (PAT_BIT(p,4) + PAT_BIT(p,3) + PAT_BIT(p,2) + PAT_BIT(p,1) + PAT_BIT(p,0))
+#define PAT_MOMENT(p)     (-4 * PAT_BIT(p,4) - 2 * PAT_BIT(p,3) + 2 * PAT_BIT(p,1) + 4 * PAT_BIT(p,0))
+                          // bit 4 is Left ... bit 0 is Right (struct sensors)
+#define PAT_CENTROID(p)   (PAT_MOMENT(p) / (PAT_COUNT(p) + ((p) == 0)))
+
+#define INNER_WHEEL(c)    ((c) <= -4 ? rev_fast : (c) == -3 ? rev_slow : (c) == -2 ? stop : \
+                           (c) == -1 ? slow : fast)
+                          // setting of the left wheel for centroid c, the right wheel
+                          // uses INNER_WHEEL(-c)
+
+#define PATTERN_RULE(p)   { (p) == 0 ? PATTERN_BRAKE : INNER_WHEEL(PAT_CENTROID(p)),    \
+                            (p) == 0 ? PATTERN_BRAKE : INNER_WHEEL(-PAT_CENTROID(p)) }
+
+#endif // PATTERN_RULES_H
@@ -0,0 +1,217 @@
+// persist.c
+//   Warm restart state and the reset log, see persist.h
+//   rev. Oct. 17, 2026 the state goes back through an image the recorder logs
+//   rev. Oct. 17, 2026 the lap count goes back through lap_map_resume()
+//   rev. Oct. 17, 2026 first version
+
+#include "persist.h"
+
+#ifdef SUPERVISOR
+
+#include <stdio.h>
+#include <string.h>
+#include "hal.h"
+#include "sumovore.h"
+#include "motor_control.h"
+#include "calibration.h"
+#include "lap_map.h"
+#include "line_position.h"
+#include "line_recovery.h"
+#include "eeprom.h"
+#include "telem_frame.h"
+#include "record.h"
+
+#ifdef HAL_SIM
+#define PERSISTENT                 // the simulator has no reset to survive
+#else
+#define PERSISTENT persistent      // XC8: not cleared (or initialized) at start up
+#endif
+
+struct persist_slot
+{
+    unsigned char magic;
+    unsigned char seq;             // one ahead in the newer slot
+    unsigned char reset_count[RESET_CAUSES];
+    unsigned char reset_last;
+    unsigned char control_mode;
+    unsigned char lap_learning;
+    unsigned char line_last_pattern;
+    int line_position;
+    unsigned int sensor_min[LINE_SENSORS];
+    unsigned int sensor_threshold[LINE_SENSORS];
+    unsigned int sensor_gain[LINE_SENSORS];
+    unsigned int lap_count;
+    unsigned char lap_segments;    // 0 unless the map is complete
+    struct lap_segment lap_map[LAP_MAP_SEGMENTS];
+    unsigned int check;            // Fletcher-16 of everything above
+};
+
+unsigned char reset_count[RESET_CAUSES];
+unsigned char reset_last;
+
+static PERSISTENT struct persist_slot slot[2];
+static unsigned char newest;           // slot persist_task() wrote last
+static unsigned char resume;           // 1 from persist_reset() to persist_resume()
+static unsigned char log_image[EE_RESET_LOG_SIZE];
+static unsigned char image[PERSIST_IMAGE_SIZE];   // see persist.h
+static unsigned char image_used;                  //   bytes of it pack() filled
+
+static unsigned int fletcher16(const unsigned char *p, unsigned int n)
+{
+    unsigned int a = 0, b = 0;         // sums mod 255
+
+    while (n--)
+    {
+        a += *p++;
+        if (a >= 255u) a -= 255u;
+        b += a;
+        if (b >= 255u) b -= 255u;
+    }
+    return (b << 8) | a;
+}
+
+static unsigned char good(const struct persist_slot *s)
+{
+    return s->magic == PERSIST_MAGIC
+        && s->control_mode <= (unsigned char)pid_steering
+        && s->lap_segments <= LAP_MAP_SEGMENTS
+        && s->check == fletcher16((const unsigned char *)s, sizeof *s - sizeof s->check);
+}
+
+// lifetime counts in the data EEPROM; eeprom_task() writes them in the
+// background, the trap in reset_codes() waits for it
+static void log_reset(unsigned char cause)
+{
+    unsigned char i;
+
+    for (i = 0; i < EE_RESET_LOG_SIZE; i++) log_image[i] = eeprom_read((unsigned char)(EE_RESET_LOG + i));
+    if (log_image[0] != RESET_LOG_MAGIC
+        || telem_crc8(log_image, EE_RESET_LOG_SIZE - 1u) != log_image[EE_RESET_LOG_SIZE - 1u])
+    {
+        memset(log_image, 0, sizeof log_image);
+        log_image[0] = RESET_LOG_MAGIC;
+    }
+    if (log_image[1 + cause] != 255u) log_image[1 + cause]++;
+    log_image[1 + RESET_CAUSES] = cause;
+    log_image[EE_RESET_LOG_SIZE - 1u] = telem_crc8(log_image, EE_RESET_LOG_SIZE - 1u);
+    eeprom_queue(EE_RESET_LOG, log_image, EE_RESET_LOG_SIZE);
+}
+
+unsigned char persist_reset(unsigned char cause)
+{
+    unsigned char g0, g1;
+
+    resume = 0;
+    memset(reset_count, 0, sizeof reset_count);
+    if (cause == reset_por) memset(slot, 0, sizeof slot);   // RAM holds no state after a POR
+    else
+    {
+        g0 = good(&slot[0]);
+        g1 = good(&slot[1]);
+        if (g0 && g1) newest = ((unsigned char)(slot[1].seq - slot[0].seq) == 1u) ? 1u : 0u;
+        else newest = g1;
+        if (g0 || g1)
+        {
+            memcpy(reset_count, slot[newest].reset_count, sizeof reset_count);
+            resume = 1;
+        }
+    }
+    if (reset_count[cause] != 255u) reset_count[cause]++;
+    reset_last = cause;
+    log_reset(cause);
+    return resume;
+}
+
+static unsigned char *put16(unsigned char *p, unsigned int v)
+{
+    p[0] = (unsigned char)v;
+    p[1] = (unsigned char)(v >> 8);
+    return p + 2;
+}
+
+static unsigned int get16(const unsigned char *p)
+{
+    return p[0] | ((unsigned int)p[1] << 8);
+}
+
+// the slot into image[]
+static void pack(const struct persist_slot *s)
+{
+    unsigned char *p = image, i;
+
+    *p++ = s->control_mode;
+    *p++ = s->lap_learning;
+    *p++ = s->line_last_pattern;
+    p = put16(p, (unsigned int)s->line_position);
+    p = put16(p, s->lap_count);
+    for (i = 0; i < LINE_SENSORS; i++) p = put16(p, s->sensor_min[i]);
+    for (i = 0; i < LINE_SENSORS; i++) p = put16(p, s->sensor_threshold[i]);
+    for (i = 0; i < LINE_SENSORS; i++) p = put16(p, s->sensor_gain[i]);
+    *p++ = s->lap_segments;
+    for (i = 0; i < s->lap_segments; i++)
+    {
+        *p++ = s->lap_map[i].kind;
+        p = put16(p, s->lap_map[i].length);
+    }
+    image_used = (unsigned char)(p - image);
+}
+
+void persist_apply(const unsigned char *p)
+{
+    unsigned char i, n;
+
+    control_mode = (enum control_mode)p[0];
+    lap_learning = p[1];
+    line_last_pattern = p[2];
+    line_position = (int)(short)get16(p + 3);
+    lap_map_resume(get16(p + 5));
+    p += 7;
+    for (i = 0; i < LINE_SENSORS; i++, p += 2) sensor_min[i] = get16(p);
+    for (i = 0; i < LINE_SENSORS; i++, p += 2) sensor_threshold[i] = get16(p);
+    for (i = 0; i < LINE_SENSORS; i++, p += 2) sensor_gain[i] = get16(p);
+    calibrating = 0;
+    n = *p++;
+    if (n == 0u || n > LAP_MAP_SEGMENTS) return;   // the map lap_map_init() loaded stays
+    for (i = 0; i < n; i++, p += 3)
+    {
+        lap_map[i].kind = p[0];
+        lap_map[i].length = get16(p + 1);
+    }
+    lap_segments = n;
+}
+
+void persist_resume(void)
+{
+    if (!resume) return;
+    resume = 0;
+    pack(&slot[newest]);
+    persist_apply(image);
+    record_resume(image, image_used);   // so a replay starts from here too
+    printf("warm restart: %u WDT %u BOR %u STKFUL %u other since power up\n\r", reset_count[reset_wdt],
+           reset_count[reset_bor], reset_count[reset_stkful], reset_count[reset_other]);
+}
+
+void persist_task(void)
+{
+    struct persist_slot *s = &slot[newest ^ 1u];
+
+    s->magic = 0;                      // not good until the checksum is in
+    s->seq = (unsigned char)(slot[newest].seq + 1u);
+    memcpy(s->reset_count, reset_count, sizeof reset_count);
+    s->reset_last = reset_last;
+    s->control_mode = (unsigned char)control_mode;
+    s->lap_learning = lap_learning;
+    s->line_last_pattern = line_last_pattern;
+    s->line_position = line_position;
+    memcpy(s->sensor_min, sensor_min, sizeof sensor_min);
+    memcpy(s->sensor_threshold, sensor_threshold, sizeof sensor_threshold);
+    memcpy(s->sensor_gain, sensor_gain, sizeof sensor_gain);
+    s->lap_count = lap_count;
+    s->lap_segments = (lap_state == lap_recording) ? 0u : lap_segments;
+    if (s->lap_segments) memcpy(s->lap_map, lap_map, sizeof lap_map);
+    s->magic = PERSIST_MAGIC;
+    s->check = fletcher16((const unsigned char *)s, sizeof *s - sizeof s->check);
+    newest ^= 1u;
+}
+
+#endif // SUPERVISOR
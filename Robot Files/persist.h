@@ -0,0 +1,69 @@
+// persist.h
+//   Watchdog supervisor and warm restart (SUPERVISOR).
+//   Define SUPERVISOR on the compiler command line (as TELEMETRY) to turn the
+//   watchdog timer on (about 32 ms, main() clears it every tick) and to keep
+//   the robot running through a reset that is not a power on reset:
+//     persist_task() copies the state below every PERSIST_PERIOD_TICKS into
+//     one of two slots of RAM the C startup code leaves alone (XC8's
+//     persistent), each with a sequence number and a Fletcher-16 checksum,
+//     taking turns so a reset in the middle of a copy leaves the other good.
+//     After a WDT, BOR, stack overflow or software reset reset_codes()
+//     (hal_pic18.c) calls persist_reset(): with a good slot it shows the
+//     reset code in the background instead of trapping, and persist_resume()
+//     puts the state back once main() has run the *_init() functions. The
+//     robot drives again on the first control tick.
+//   State kept: control_mode, lap_learning, the calibration (sensor_min[],
+//   sensor_threshold[], sensor_gain[]), the lap map once it is complete with
+//   lap_count (the map is raced again from the next stripe), and the last
+//   line pattern and line_position, so line recovery (line_recovery.h)
+//   steers toward the line instead of braking as it does after a power up.
+//   Resets are counted by cause in reset_count[] (cleared by a POR) and in
+//   the data EEPROM at EE_RESET_LOG (counts saturate at 255, never cleared),
+//   so they can be read back later, e.g. with the flight recorder's EEPROM
+//   records.
+//   rev. Oct. 17, 2026 the resumed state as an image for the flight recorder
+//   rev. Oct. 17, 2026 first version
+
+#ifndef PERSIST_H
+#define PERSIST_H
+
+#define PERSIST_MAGIC     0x5Eu
+#define RESET_LOG_MAGIC   0x4Cu
+#define EE_RESET_LOG_SIZE (1u + RESET_CAUSES + 2u)   // magic, counts, last cause, CRC-8
+
+enum reset_cause { reset_por, reset_bor, reset_wdt, reset_stkful, reset_other, RESET_CAUSES };
+
+#ifdef SUPERVISOR
+
+#include "sumovore.h"     // LINE_SENSORS
+#include "lap_map.h"      // LAP_MAP_SEGMENTS
+
+#define PERSIST_IMAGE_SIZE (7u + 6u * LINE_SENSORS + 1u + 3u * LAP_MAP_SEGMENTS)
+                 // the state persist_resume() puts back as bytes, low byte first:
+                 // control_mode, lap_learning, line_last_pattern, line_position,
+                 // lap_count, sensor_min[], sensor_threshold[], sensor_gain[],
+                 // lap_segments and that many lap_map[] entries (kind, length)
+
+extern unsigned char reset_count[RESET_CAUSES];   // since the last POR
+extern unsigned char reset_last;                  // enum reset_cause
+
+unsigned char persist_reset(unsigned char cause);
+                 // from reset_codes(): counts and logs the reset. A POR clears the
+                 // slots and returns 0, any other cause returns 1 if there is a
+                 // good slot to resume from
+void persist_resume(void);
+                 // from main() after calibration_init() and lap_map_init(): puts the
+                 // state of the good slot back, nothing after a POR or a cold start.
+                 // With RECORD the state also goes to the flight recorder (REC_RESUME)
+void persist_apply(const unsigned char *image);
+                 // puts back the state of an image of PERSIST_IMAGE_SIZE bytes at most;
+                 // persist_resume() uses it, and sim/replay.c on the REC_RESUME records
+void persist_task(void);   // a scheduler task, see tasks.c
+
+#else
+
+#define persist_resume()
+
+#endif // SUPERVISOR
+
+#endif // PERSIST_H
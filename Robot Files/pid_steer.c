@@ -0,0 +1,35 @@
+// pid_steer.c
+//   Fixed point PID steering, see pid_steer.h
+//   rev. Oct. 17, 2026 first version
+
+#include "pid_steer.h"
+
+struct pid_gains pid = { PID_KP_DEFAULT, PID_KI_DEFAULT, PID_KD_DEFAULT };
+
+static int integral;
+static int last_error;
+
+void pid_steer_reset(void)
+{
+    integral = 0;
+    last_error = 0;
+}
+
+int pid_steer_update(int error)
+{
+    long out;
+
+    integral += error;                    // error is at most +-512 so this cannot
+    if (integral > PID_I_LIMIT) integral = PID_I_LIMIT;   // overflow before the clamp
+    else if (integral < -PID_I_LIMIT) integral = -PID_I_LIMIT;
+
+    out = (long)pid.kp * error
+        + (long)pid.ki * integral
+        + (long)pid.kd * (error - last_error);
+    last_error = error;
+
+    out >>= PID_SHIFT;                    // arithmetic shift: rounds toward -infinity
+    if (out > PID_OUT_LIMIT) return PID_OUT_LIMIT;
+    if (out < -PID_OUT_LIMIT) return -PID_OUT_LIMIT;
+    return (int)out;
+}
@@ -0,0 +1,40 @@
+// pid_steer.h
+//   Fixed point PID steering for the pid_steering mode of motor_control().
+//   The error is line_position (see line_position.h), the output is a duty
+//   cycle difference handed to set_motor_speed() as speed_modifier.
+//   Integer only: three 16x16 bit multiplies into a long and a shift, so
+//   every update takes the same bounded number of cycles.
+//   rev. Oct. 17, 2026 the default gains can come from tuned.h (TUNED, see sumovore.h)
+//   rev. Oct. 17, 2026 first version
+
+#ifndef PID_STEER_H
+#define PID_STEER_H
+
+#define PID_SHIFT        8        // gains are in 1/256 units (Q8)
+#ifdef TUNED
+#include "tuned.h"
+#endif
+#ifndef PID_KP_DEFAULT
+#define PID_KP_DEFAULT   320      // 1.25  duty per line_position unit
+#define PID_KI_DEFAULT   2        // 0.008 duty per accumulated unit per frame
+#define PID_KD_DEFAULT   1536     // 6.0   duty per line_position unit change per frame
+#endif
+#define PID_I_LIMIT      8000     // anti windup clamp on the accumulated error
+#define PID_OUT_LIMIT    1600     // full forward on one wheel, full reverse on the other
+
+struct pid_gains
+{
+    int kp;
+    int ki;
+    int kd;
+};
+
+extern struct pid_gains pid;  // can be changed from main.c like threshold
+
+void pid_steer_reset(void);
+int pid_steer_update(int error);
+                 // error: line_position, + when the line is to the right
+                 // returns the steering term, + means turn right (left wheel faster)
+                 // call once per new sensor frame so the D and I terms see a fixed period
+
+#endif // PID_STEER_H
@@ -0,0 +1,178 @@
+// record.c
+//   Flight recorder, see record.h
+//   rev. Oct. 17, 2026 warm restart records
+//   rev. Oct. 17, 2026 obstacle records
+//   rev. Oct. 17, 2026 the reset log with SUPERVISOR
+//   rev. Oct. 17, 2026 battery records
+//   rev. Oct. 17, 2026 first version
+
+#include "record.h"
+
+#ifdef RECORD
+
+#include "sumovore.h"
+#include "motor_control.h"
+#include "pid_steer.h"
+#include "sched.h"
+#include "uart_tx.h"
+#include "telem_frame.h"
+#include "eeprom.h"
+#include "lap_map.h"
+#include "hal.h"
+#include "battery.h"
+#include "persist.h"
+#include "obstacle.h"
+
+#ifdef SUPERVISOR
+#define EEPROM_END  (EE_RESET_LOG + EE_RESET_LOG_SIZE)   // the bytes the start up code reads
+#else
+#define EEPROM_END  (EE_LAP_MAP + EE_LAP_MAP_SIZE)
+#endif
+
+unsigned int record_dropped;
+
+static unsigned char ring[RECORD_RING][REC_SIZE];
+static unsigned char head;      // next free record
+static unsigned char tail;      // next record to send (all of this runs in the main line)
+static unsigned char seq;
+
+// a free record with its header filled in, or 0 (counted as dropped) when
+// the ring is full; put() then adds the CRC and hands it to record_task()
+static unsigned char *get(unsigned char type)
+{
+    unsigned char next = (unsigned char)((head + 1u) % RECORD_RING), *r;
+
+    if (next == tail)
+    {
+        record_dropped++;
+        seq++;                  // so the host sees the gap
+        return 0;
+    }
+    r = ring[head];
+    r[0] = REC_SYNC;
+    r[1] = type;
+    r[2] = seq++;
+    return r;
+}
+
+static void put(unsigned char *r)
+{
+    r[REC_SIZE - 1u] = telem_crc8(r + 1, REC_SIZE - 2u);
+    head = (unsigned char)((head + 1u) % RECORD_RING);
+}
+
+static void put16(unsigned char *p, int v)
+{
+    p[0] = (unsigned char)v;
+    p[1] = (unsigned char)((unsigned int)v >> 8);
+}
+
+void record_start(void)
+{
+    unsigned char *r, addr, i, n;
+
+    head = tail = 0;
+    if ((r = get(REC_SETTINGS)))
+    {
+        r[3] = REC_VERSION;
+        r[4] = (unsigned char)control_mode;
+        r[5] = lap_learning;
+        r[6] = hal_ir_detect();
+        put16(r + 7, (int)threshold);
+        put16(r + 9, pid.kp);
+        put16(r + 11, pid.ki);
+        put16(r + 13, pid.kd);
+        put(r);
+    }
+    if ((r = get(REC_SPEEDS)))
+    {
+        for (i = 0, n = 3; i < 7u; i++)
+        {
+            if (i == stop) continue;
+            put16(r + n, motor_speeds[i]);
+            n += 2u;
+        }
+        put(r);
+    }
+    for (addr = 0; addr < EEPROM_END; addr += REC_EEPROM_BYTES)
+    {
+        if (!(r = get(REC_EEPROM))) break;
+        n = (EEPROM_END - addr < REC_EEPROM_BYTES) ? (unsigned char)(EEPROM_END - addr) : REC_EEPROM_BYTES;
+        r[3] = addr;
+        r[4] = n;
+        for (i = 0; i < REC_EEPROM_BYTES; i++) r[5 + i] = i < n ? eeprom_read((unsigned char)(addr + i)) : 0u;
+        put(r);
+    }
+}
+
+void record_pass(void)
+{
+    unsigned char *r = get(REC_PASS);
+    unsigned int l, rt;
+
+    if (!r) return;
+    l = (unsigned int)motor_duty[left];
+    rt = (unsigned int)motor_duty[right];
+    put16(r + 3, (int)sched_time);
+    r[5] = (unsigned char)line_adc[0];
+    r[6] = (unsigned char)line_adc[1];
+    r[7] = (unsigned char)line_adc[2];
+    r[8] = (unsigned char)line_adc[3];
+    r[9] = (unsigned char)line_adc[4];
+    r[10] = (unsigned char)(((line_adc[0] >> 8) & 3u) | (((line_adc[1] >> 8) & 3u) << 2)
+                          | (((line_adc[2] >> 8) & 3u) << 4) | (((line_adc[3] >> 8) & 3u) << 6));
+    r[11] = (unsigned char)((line_adc[4] >> 8) & 3u);
+    if (line_frame_new) r[11] |= REC_NEW_FRAME;
+    r[12] = (unsigned char)l;
+    r[13] = (unsigned char)(((l >> 8) & 0x0fu) | ((rt & 0x0fu) << 4));
+    r[14] = (unsigned char)(rt >> 4);
+    put(r);
+}
+
+void record_battery(void)
+{
+    unsigned char *r = get(REC_BATTERY), i;
+
+    if (!r) return;
+    put16(r + 3, (int)battery_mv);
+    put16(r + 5, (int)battery_scale);
+    r[7] = battery_low;
+    for (i = 8; i < REC_SIZE - 1u; i++) r[i] = 0;
+    put(r);
+}
+
+void record_obstacle(void)
+{
+    unsigned char *r = get(REC_OBSTACLE), i;
+
+    if (!r) return;
+    r[3] = obstacle_seen;
+    r[4] = obstacle_action;
+    put16(r + 5, (int)obstacle_events);
+    for (i = 7; i < REC_SIZE - 1u; i++) r[i] = 0;
+    put(r);
+}
+
+void record_resume(const unsigned char *image, unsigned char n)
+{
+    unsigned char *r, offset, i;
+
+    for (offset = 0; offset < n; offset += REC_RESUME_BYTES)
+    {
+        if (!(r = get(REC_RESUME))) break;
+        r[3] = offset;
+        for (i = 0; i < REC_RESUME_BYTES; i++) r[4 + i] = (offset + i < n) ? image[offset + i] : 0u;
+        put(r);
+    }
+}
+
+void record_task(void)
+{
+    while (tail != head && uart_tx_free() >= REC_SIZE)
+    {
+        uart_tx_write(ring[tail], REC_SIZE);
+        tail = (unsigned char)((tail + 1u) % RECORD_RING);
+    }
+}
+
+#endif // RECORD
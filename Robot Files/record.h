@@ -0,0 +1,108 @@
+// record.h
+//   Flight recorder for offline replay (sim/replay.c). With RECORD defined
+//   the robot streams everything the control loop needs to be re-run
+//   bit for bit on the host: at start up its settings and the data EEPROM
+//   that calibration_init() and lap_map_init() read, then one record per
+//   control pass with the raw sensor frame check_sensors() got and the
+//   duty both motors were given. Records are queued in a RAM ring and
+//   record_task() moves whole records into the USART buffer as it drains,
+//   so printf text can share the link. A record that does not fit in the
+//   ring is dropped and counted; the sequence number shows the gap.
+//
+//   Every record is REC_SIZE bytes:
+//   byte  0      REC_SYNC
+//         1      type, REC_SETTINGS, REC_SPEEDS, REC_EEPROM, REC_PASS, REC_BATTERY,
+//                REC_OBSTACLE or REC_RESUME
+//         2      sequence number (wraps at 256)
+//         3-14   payload, multi byte values low byte first
+//         15     CRC-8 of bytes 1-14 (telem_crc8(), telem_frame.h)
+//
+//   REC_SETTINGS  REC_VERSION, control_mode, lap_learning, hal_ir_detect() at
+//                 start up, threshold, pid.kp, pid.ki, pid.kd (16 bit each)
+//   REC_SPEEDS    motor_speeds[] except stop, 16 bit each, rev_fast first
+//   REC_EEPROM    address, count (1-10), count bytes of the data EEPROM
+//   REC_PASS      sched_time (16 bit), low 8 bits of the five readings
+//                 (line_adc[], left first), bits 9:8 of readings 0..3 (two
+//                 bits each, reading 0 lowest), bits 9:8 of reading 4 in
+//                 bits 1:0 and line_frame_new in bit 7, then both motor_duty[]
+//                 as 12 bit two's complement packed as in telem_frame.h
+//   REC_BATTERY   battery_mv, battery_scale (16 bit each), battery_low, sent
+//                 by battery_task() when the scale or the tier changes; the
+//                 duties of the passes after it depend on them (battery.h)
+//   REC_OBSTACLE  obstacle_seen, obstacle_action, obstacle_events (16 bit),
+//                 sent by obstacle_task() on every event (obstacle.h)
+//   REC_RESUME    offset, then REC_RESUME_BYTES bytes of the state a warm
+//                 restart put back (PERSIST_IMAGE_SIZE, persist.h) from that
+//                 offset; sent by persist_resume() after the start up records,
+//                 ahead of the first REC_PASS, and only with SUPERVISOR
+//
+//   RECORD needs the 500000 baud link of TELEMETRY. Link budget per 1.024 ms
+//   tick: 500000 baud / 10 bits a byte is 51 bytes; a REC_PASS record takes
+//   16 of them, and the rest carries the start up and event records and the
+//   printf text (instrument.h, report_status()) in bursts the ring absorbs.
+//   TELEMETRY's 16 byte frame per pass on top of that overruns the 128 byte
+//   USART ring (uart_tx.h) and records are dropped, which replay cannot get
+//   past, so the two cannot be built together.
+//   rev. Oct. 17, 2026 REC_RESUME
+//   rev. Oct. 17, 2026 RECORD and TELEMETRY together are an error
+//   rev. Oct. 17, 2026 REC_OBSTACLE
+//   rev. Oct. 17, 2026 REC_BATTERY
+//   rev. Oct. 17, 2026 first version
+
+#ifndef RECORD_H
+#define RECORD_H
+
+#if defined(RECORD) && defined(TELEMETRY)
+#error "RECORD and TELEMETRY both stream every control pass, the USART cannot carry both (see above)"
+#endif
+
+// #define RECORD        // uncomment (or define it on the compiler command line)
+                         //   to stream the flight recorder at 500000 baud
+
+#define REC_SYNC      0x5au
+#define REC_VERSION   1u
+#define REC_SIZE      16u
+#define REC_SETTINGS  'S'
+#define REC_SPEEDS    'M'
+#define REC_EEPROM    'E'
+#define REC_PASS      'P'
+#define REC_BATTERY   'B'
+#define REC_OBSTACLE  'O'
+#define REC_RESUME    'R'
+#define REC_RESUME_BYTES  11u    // per REC_RESUME record
+#define REC_EEPROM_BYTES  10u    // per REC_EEPROM record
+#define REC_NEW_FRAME     0x80u  // in byte 11 of a REC_PASS record
+
+#ifdef SUPERVISOR
+#define RECORD_RING   40u        // the start up records (21 with the reset log), up to
+                                 //   13 REC_RESUME and a few control passes while
+                                 //   printf text goes out
+#else
+#define RECORD_RING   24u        // records, enough for the start up records and a
+                                 //   few control passes while printf text goes out
+#endif
+
+#ifdef RECORD
+
+extern unsigned int record_dropped;   // records that did not fit in the ring
+
+void record_start(void);  // queues the settings and the data EEPROM; called from main()
+                          //   after the settings are made, before calibration_init()
+void record_pass(void);   // called after motor_output_update() in the control task
+void record_task(void);   // a scheduler task, see tasks.c
+void record_battery(void);  // called by battery_task() on a change
+void record_obstacle(void); // called by obstacle_task() on an event
+void record_resume(const unsigned char *image, unsigned char n);
+                            // called by persist_resume() with the n bytes it put back
+
+#else
+
+#define record_start()
+#define record_pass()
+#define record_battery()
+#define record_obstacle()
+#define record_resume(image, n)
+
+#endif // RECORD
+
+#endif // RECORD_H
@@ -0,0 +1,50 @@
+// sched.c
+//   Fixed rate cyclic executive, see sched.h
+//   rev. Oct. 17, 2026 first version
+
+#include "hal.h"
+#include "sched.h"
+#include "instrument.h"
+
+unsigned int sched_time;
+unsigned int sched_slips;
+unsigned char sched_load_max;
+unsigned int sched_load_avg;
+
+static volatile unsigned char ticks;  // only written by the Timer0 ISR
+static unsigned char serviced;        // last tick sched_run() has handled
+
+void sched_tick_isr(void)
+{
+    ticks++;
+}
+
+void sched_run(struct sched_task *task, unsigned char count)
+{
+    unsigned char now, load;
+
+    while (ticks == serviced) hal_idle();   // wait for the next tick
+    now = ticks;
+    if ((unsigned char)(now - serviced) != 1u) sched_slips += (unsigned char)(now - serviced - 1u);
+    sched_time += (unsigned char)(now - serviced);
+    serviced = now;
+
+    PROBE_BEGIN(probe_tick);
+    for ( ; count != 0u; count--, task++)
+    {
+        if (task->countdown == 0u)
+        {
+            task->countdown = task->period;
+            task->run();
+            task->runs++;
+            if ((unsigned char)(ticks - now) >= task->period) task->overruns++;
+        }
+        task->countdown--;
+    }
+    PROBE_END(probe_tick);
+
+    // how far into the tick the work above went: the CPU headroom left
+    load = (ticks == now) ? hal_tick_phase() : 255u;
+    if (load > sched_load_max) sched_load_max = load;
+    sched_load_avg += load - (sched_load_avg >> 8);
+}
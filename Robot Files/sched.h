@@ -0,0 +1,35 @@
+// sched.h
+//   Fixed rate cyclic executive.
+//   Timer0 overflows every SCHED_TICK_US and its interrupt counts a tick.
+//   sched_run() waits for the next tick and runs every task that is due on
+//   it, in table order, so the first task in the table has the highest
+//   priority. A task with period n runs on every n-th tick.
+//   rev. Oct. 17, 2026 first version
+
+#ifndef SCHED_H
+#define SCHED_H
+
+#define SCHED_TICK_US  1024u   // Timer0, 8 bit, Fosc/4 with 1:32 prescale: 256 * 4 us
+                               // it free runs (no reload) so the period has no drift
+
+struct sched_task
+{
+    void (*run)(void);
+    unsigned int period;     // ticks between releases
+    unsigned int countdown;  // ticks until the next release, the initial value
+                             //   offsets a sub-rate task from the others
+    unsigned int runs;
+    unsigned int overruns;   // releases that finished after the next release was due
+};
+
+extern unsigned int sched_time;        // ticks since start up, wraps at 65536
+extern unsigned int sched_slips;       // ticks that went by without being serviced
+extern unsigned char sched_load_max;   // busiest tick so far, in 1/256 of a tick
+extern unsigned int sched_load_avg;    // average busy part of a tick, in 1/256 of a
+                                       //   tick times 256 (running average over ~256 ticks)
+
+void sched_tick_isr(void);  // called from the Timer0 interrupt
+void sched_run(struct sched_task *task, unsigned char count);
+                 // services one tick: waits for it, then runs the tasks due
+
+#endif // SCHED_H
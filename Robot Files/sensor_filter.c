@@ -0,0 +1,32 @@
+// sensor_filter.c
+//   IIR and hysteresis stages of the sensor filtering, see sensor_filter.h
+//   rev. Oct. 17, 2026 first version
+
+#include "sensor_filter.h"
+#include "calibration.h"
+
+unsigned int line_filt[LINE_SENSORS];
+
+static unsigned int acc[LINE_SENSORS];   // 2^SENSOR_IIR_SHIFT * line_filt[], keeps the fraction
+static unsigned char seeded;
+
+void sensor_filter_update(const unsigned int *raw)
+{
+    unsigned char i;
+
+    for (i = 0; i < LINE_SENSORS; i++)
+    {
+        if (seeded) acc[i] = acc[i] - (acc[i] >> SENSOR_IIR_SHIFT) + raw[i];
+        else acc[i] = raw[i] << SENSOR_IIR_SHIFT;
+        line_filt[i] = acc[i] >> SENSOR_IIR_SHIFT;   // at most 1023 << 6, fits an unsigned int
+    }
+    seeded = 1;
+}
+
+unsigned char sensor_filter_bit(unsigned char sensor, unsigned char was_on)
+{
+    unsigned int t = sensor_threshold[sensor];
+
+    if (was_on) return line_filt[sensor] + SENSOR_HYSTERESIS > t;   // falling threshold
+    return line_filt[sensor] > t + SENSOR_HYSTERESIS;               // rising threshold
+}
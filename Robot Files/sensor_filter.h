@@ -0,0 +1,30 @@
+// sensor_filter.h
+//   Filtering between the ADC scan and SeeLine.
+//     oversampling  ADC_OVERSAMPLE_SHIFT in adc_scan.h, each frame value is the
+//                   mean of 2^n back to back conversions (done in the ADC interrupt)
+//     IIR           one pole low pass per sensor, new = old + (x - old) / 2^SENSOR_IIR_SHIFT,
+//                   run once for each new frame. 0 turns it off.
+//     hysteresis    a sensor bit turns on above sensor_threshold + SENSOR_HYSTERESIS
+//                   and off below sensor_threshold - SENSOR_HYSTERESIS, so noise
+//                   near the threshold does not make SeeLine flicker
+//   Integer only: a shift, an add and a subtract per sensor and frame.
+//   rev. Oct. 17, 2026 first version
+
+#ifndef SENSOR_FILTER_H
+#define SENSOR_FILTER_H
+
+#include "sumovore.h"
+
+#define SENSOR_IIR_SHIFT    1      // 0 to 6; each step about doubles the lag (in frames)
+#define SENSOR_HYSTERESIS   24u    // ADC counts either side of the threshold
+
+extern unsigned int line_filt[LINE_SENSORS];   // filtered line_adc[], 0 to 1023
+
+void sensor_filter_update(const unsigned int *raw);
+                 // feeds one new frame (raw[LINE_SENSORS]) through the IIR into line_filt[],
+                 // the first frame seeds the filter
+unsigned char sensor_filter_bit(unsigned char sensor, unsigned char was_on);
+                 // 1 if line_filt[sensor] is over the line, with hysteresis about
+                 // sensor_threshold[sensor] (calibration.h)
+
+#endif // SENSOR_FILTER_H
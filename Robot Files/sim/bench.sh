@@ -0,0 +1,22 @@
+#!/bin/sh
+# bench.sh [simulator] [extra simulator options ...]
+#   Runs every track in tracks/ in both control modes and prints one line
+#   per run: laps completed, best and mean lap time, line losses longer
+#   than 10 ms and the time spent off the line, the interrupt load of the
+#   scheduler tick and the host time one control pass takes.
+#   Example: ./bench.sh build/sumovore_sim -v 1400 -L
+#   rev. Oct. 17, 2026 first version
+
+SIM=${1:-build/sumovore_sim}
+[ $# -gt 0 ] && shift
+SECONDS_RUN=${BENCH_SECONDS:-40}
+DIR=$(dirname "$0")
+
+printf '%-12s %-6s %3s %7s %7s %4s %7s %4s %6s\n' track mode lap best mean lost off_s isr ns/pass
+for track in "$DIR"/tracks/*.track
+do
+    for mode in simple pid
+    do
+        "$SIM" -T "$track" -m $mode -t "$SECONDS_RUN" -b "$@" || exit 1
+    done
+done
@@ -0,0 +1,224 @@
+// hal_sim.c
+//   Linux simulator version of hal_pic18.c. The ADC returns what plant.c
+//   says the reflective sensors see, the PWM and direction lines are latched
+//   into sim_motor[] for the plant to read back. Every conversion costs
+//   SIM_ADC_CONVERSION_NS of simulated time, as on the PIC, and a conversion
+//   started with hal_adc_start() calls adc_scan_isr() when it is done, as
+//   low_isr() in interrupts.c does. Timer0 overflows every SCHED_TICK_US and
+//   calls sched_tick_isr(). The USART takes SIM_UART_BYTE_NS per byte and
+//   calls uart_tx_isr() while its transmit interrupt is enabled and it can
+//   take another byte; what it sends is written to sim_uart.
+//   Main line code takes no simulated time; the interrupt handlers take
+//   SIM_ADC_ISR_NS and SIM_TICK_ISR_NS, and hal_idle() moves time on to the
+//   next interrupt.
+//   The data EEPROM is sim_eeprom[] (sim_main.c can load and save it), a
+//   byte write keeps it busy for SIM_EEPROM_WRITE_NS.
+//   rev. Oct. 17, 2026 sim_frame_ns[], when each reading of the published frame
+//                      was converted
+//   rev. Oct. 17, 2026 data EEPROM and IR detectors
+//   rev. Oct. 17, 2026 first version
+
+#include <stdarg.h>
+#include <string.h>
+#include "sumovore.h"
+#include "hal.h"
+#include "adc_scan.h"
+#include "sched.h"
+#include "uart_tx.h"
+#include "sim.h"
+
+#define TICK_NS  (SCHED_TICK_US * 1000ull)
+
+struct sim_motor sim_motor[2];
+unsigned char sim_leds;
+unsigned long long sim_time_ns;
+FILE *sim_uart;
+unsigned char sim_eeprom[SIM_EEPROM_SIZE];
+unsigned char sim_ir;
+unsigned long long sim_frame_ns[LINE_SENSORS];
+
+static unsigned char adc_busy, adc_channel;
+static unsigned long long adc_done_ns;
+static unsigned int adc_result;
+static unsigned long long tick_ns;   // next Timer0 overflow
+static unsigned char uart_irq;
+static unsigned long long uart_free_ns;  // when TXREG can take the next byte
+static unsigned long long eeprom_done_ns; // end of the last EEPROM write
+static unsigned long long converted_ns[LINE_SENSORS];   // last conversion of each sensor
+
+void initialization(void)
+{
+    SeeLine.B = 0;
+    sim_time_ns = 0;
+    sim_leds = 0;
+    sim_motor[left].duty = 0;
+    sim_motor[left].fwd = NO;
+    sim_motor[left].fwd_cmp = NO;
+    sim_motor[right] = sim_motor[left];
+    adc_busy = 0;
+    tick_ns = TICK_NS;
+    uart_irq = 0;
+    uart_free_ns = 0;
+    eeprom_done_ns = 0;
+    uart_tx_start();
+    adc_scan_start();
+    threshold = THRESHOLD_DEFAULT;
+}
+
+static void run_until(unsigned long long t_ns)
+{
+    plant_step((t_ns - sim_time_ns) * 1e-9);
+    sim_time_ns = t_ns;
+}
+
+// runs the first interrupt handler due at or before end_ns and returns the
+// time it took, 0 if nothing is due
+static unsigned long interrupt_due(unsigned long long end_ns)
+{
+    enum { timer0, adc, uart } source = timer0;
+    unsigned long long t_ns = tick_ns;
+    unsigned int frame[LINE_SENSORS];
+    unsigned char count;
+
+    if (adc_busy && adc_done_ns < t_ns) t_ns = adc_done_ns, source = adc;
+    if (uart_irq && uart_free_ns < t_ns) t_ns = uart_free_ns, source = uart;
+    if (t_ns > end_ns) return 0;
+    if (t_ns > sim_time_ns) run_until(t_ns);   // a byte may have been ready for a while
+
+    switch (source)
+    {
+    case adc:
+        adc_result = plant_adc(adc_channel);
+        adc_busy = 0;
+        if (adc_channel < LINE_SENSORS) converted_ns[adc_channel] = sim_time_ns;
+        count = adc_scan_read(frame);
+        adc_scan_isr();              // normally starts the next conversion
+        if (adc_scan_read(frame) != count) memcpy(sim_frame_ns, converted_ns, sizeof sim_frame_ns);
+        return SIM_ADC_ISR_NS;
+    case uart:
+        uart_tx_isr();
+        return SIM_UART_ISR_NS;
+    default:
+        tick_ns += TICK_NS;
+        sched_tick_isr();
+        return SIM_TICK_ISR_NS;
+    }
+}
+
+void sim_advance(unsigned long ns)
+{
+    unsigned long long end_ns = sim_time_ns + ns;
+    unsigned long isr_ns;
+
+    while ((isr_ns = interrupt_due(end_ns)) != 0) end_ns += isr_ns;
+    run_until(end_ns);
+}
+
+// the firmware's printf(): formats the text and hands it to putch()
+int sim_printf(const char *format, ...)
+{
+    char text[256];
+    va_list args;
+    int i, n;
+
+    va_start(args, format);
+    n = vsnprintf(text, sizeof text, format, args);
+    va_end(args);
+    for (i = 0; i < n && text[i] != '\0'; i++) putch(text[i]);
+    return n;
+}
+
+unsigned int hal_adc_convert(unsigned char channel)
+{
+    sim_advance(SIM_ADC_CONVERSION_NS);
+    return plant_adc(channel);
+}
+
+void hal_adc_start(unsigned char channel)
+{
+    adc_channel = channel;
+    adc_done_ns = sim_time_ns + SIM_ADC_CONVERSION_NS;
+    adc_busy = 1;
+}
+
+unsigned int hal_adc_result(void)
+{
+    return adc_result;
+}
+
+void hal_set_pwm(enum motor_selection the_motor, unsigned int duty_cycle)
+{
+    sim_motor[the_motor].duty = duty_cycle;
+}
+
+void hal_set_direction(enum motor_selection the_motor, unsigned char fwd, unsigned char fwd_cmp)
+{
+    sim_motor[the_motor].fwd = fwd;
+    sim_motor[the_motor].fwd_cmp = fwd_cmp;
+}
+
+void hal_set_leds(unsigned char pattern)
+{
+    sim_leds = pattern & 0x1fu;
+}
+
+unsigned char hal_uart_tx_ready(void)
+{
+    if (uart_free_ns <= sim_time_ns) return 1;
+    sim_advance((unsigned long)(uart_free_ns - sim_time_ns));   // callers spin on this
+    return 0;
+}
+
+void hal_uart_write(unsigned char c)
+{
+    if (sim_uart) fputc(c, sim_uart);
+    uart_free_ns = (uart_free_ns > sim_time_ns ? uart_free_ns : sim_time_ns) + SIM_UART_BYTE_NS;
+}
+
+void hal_uart_tx_irq(unsigned char on)
+{
+    uart_irq = on;
+}
+
+unsigned char hal_tick_phase(void)
+{
+    return (unsigned char)((sim_time_ns - (tick_ns - TICK_NS)) * 256u / TICK_NS);
+}
+
+// simulated time in instruction cycles. Main line code takes no simulated
+// time, so probes around it only measure the interrupts that land inside.
+unsigned int hal_cycles(void)
+{
+    return (unsigned int)((sim_time_ns / 125u) & 0xffffu);   // Fosc/4 = 8 MHz
+}
+
+void hal_idle(void)
+{
+    unsigned long long next_ns = tick_ns;
+
+    if (adc_busy && adc_done_ns < next_ns) next_ns = adc_done_ns;
+    if (uart_irq && uart_free_ns < next_ns) next_ns = uart_free_ns;
+    if (next_ns < sim_time_ns) next_ns = sim_time_ns;
+    sim_advance((unsigned long)(next_ns - sim_time_ns));
+}
+
+unsigned char hal_eeprom_read(unsigned char addr)
+{
+    return sim_eeprom[addr];
+}
+
+void hal_eeprom_write(unsigned char addr, unsigned char data)
+{
+    sim_eeprom[addr] = data;
+    eeprom_done_ns = sim_time_ns + SIM_EEPROM_WRITE_NS;
+}
+
+unsigned char hal_eeprom_busy(void)
+{
+    return sim_time_ns < eeprom_done_ns;
+}
+
+unsigned char hal_ir_detect(void)
+{
+    return sim_ir;
+}
@@ -0,0 +1,519 @@
+// hotpath.c
+//   Checks and times the control hot path on the host: check_sensors(),
+//   set_leds(), motor_control() and set_motor_speed() with the simulated
+//   registers of hal_sim.c (sim_motor[], sim_leds) standing in for the PIC's.
+//
+//   usage: hotpath [-n calls]
+//
+//   For every one of the 32 sensor patterns a frame with those sensors over
+//   the line is fed to check_sensors() (this program provides adc_scan_read(),
+//   as replay.c does) until the filter settles, and then
+//     SeeLine.B must be the pattern and set_leds() must light the same LEDs,
+//     motor_control() in simple_curves must brake for 0b00000 and otherwise
+//       drive each wheel at the setting pattern_rules.h gives for the centroid
+//       of the pattern, worked out here again from the sensor positions,
+//     the PWM duty and direction lines must be that setting's motor_speeds[]
+//       duty after the deadband mapping of motor_output_update().
+//   The pattern rules are checked once any crossing hold (line_feature.h) has
+//   run out. The holds themselves are checked on a crossing 0b11100 and on a
+//   gap after 0b01100: both wheels fast. Lost line recovery (line_recovery.h)
+//   is checked stage by stage after 0b00010 and set_motor_speed() for its
+//   clamp at +-800 and the modifier. A status code (led_code.h) must hold
+//   the LEDs through set_leds(), flashing LED1 and LED2, and hand them back
+//   to the sensors once it is over. The IR detectors (obstacle.h) must brake
+//   the motors after OBSTACLE_ON_SAMPLES samples with both blocked, slow both
+//   wheels by OBSTACLE_SLOW_TRIM with one, and let go once clear. Built
+//   with SUPERVISOR, the warm restart state (persist.h) must come back after
+//   a watchdog reset, not after a power on reset, and the reset must be
+//   counted and logged in the EEPROM.
+//   Then each function is timed over -n calls (ns per call on this host).
+//   Exit status 0 if every check passed.
+//
+//   Instruction counts on the PIC come from the INSTRUMENT build on the
+//   robot (instrument.h): the same functions carry its probes and the
+//   cycle counts are printed over the USART once a second.
+//   rev. Oct. 17, 2026 obstacle events
+//   rev. Oct. 17, 2026 warm restart state (SUPERVISOR)
+//   rev. Oct. 17, 2026 status codes on the LEDs
+//   rev. Oct. 17, 2026 crossing and gap holds
+//   rev. Oct. 17, 2026 lost line recovery stages
+//   rev. Oct. 17, 2026 first version
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "sumovore.h"
+#include "motor_control.h"
+#include "adc_scan.h"
+#include "calibration.h"
+#include "pattern_rules.h"
+#include "line_recovery.h"
+#include "line_feature.h"
+#include "led_code.h"
+#include "tasks.h"
+#include "persist.h"
+#include "obstacle.h"
+#include "eeprom.h"
+#include "lap_map.h"
+#include "line_position.h"
+#include "sim.h"
+
+#define FLOOR_ADC    100u
+#define LINE_ADC     900u
+#define SETTLE       16     // frames for the IIR and hysteresis to settle
+#define SLEW_TICKS   30     // motor_output_update() calls to reach any duty
+
+static unsigned int frame_adc[LINE_SENSORS];
+static unsigned char frame_count;
+static unsigned int failures;
+
+void adc_scan_start(void)
+{
+}
+
+void adc_scan_isr(void)
+{
+}
+
+unsigned char adc_scan_read(unsigned int *dest)
+{
+    unsigned char i;
+
+    for (i = 0; i < LINE_SENSORS; i++) dest[i] = frame_adc[i];
+    return frame_count;
+}
+
+// feed() makes whole frames, there is no scan order to steer
+void adc_scan_focus(unsigned char sensor)
+{
+}
+
+// battery_task() gets no readings here, the duties stay unscaled
+unsigned char adc_scan_battery(unsigned int *dest)
+{
+    *dest = 0;
+    return 0;
+}
+
+// a new frame with the sensors of pattern p (bit 4 is the left sensor) on the line
+static void feed(unsigned char p)
+{
+    unsigned char i;
+
+    for (i = 0; i < LINE_SENSORS; i++) frame_adc[i] = ((p >> (4 - i)) & 1u) ? LINE_ADC : FLOOR_ADC;
+    frame_count++;
+}
+
+static void check(int ok, const char *what, unsigned int p, long got, long want)
+{
+    if (ok) return;
+    printf("FAIL pattern 0b%d%d%d%d%d: %s is %ld, expected %ld\n", (p >> 4) & 1, (p >> 3) & 1,
+           (p >> 2) & 1, (p >> 1) & 1, p & 1, what, got, want);
+    failures++;
+}
+
+// the setting pattern_rules.h documents for the left wheel at centroid c
+static enum motor_speed_setting inner_wheel(int c)
+{
+    if (c <= -4) return rev_fast;
+    if (c == -3) return rev_slow;
+    if (c == -2) return stop;
+    if (c == -1) return slow;
+    return fast;
+}
+
+// what motor_output_update() should leave on a motor's PWM for a duty
+static unsigned int pwm_for(int duty)
+{
+    unsigned int pwm = (unsigned int)(duty < 0 ? -duty : duty);
+
+    return pwm ? MOTOR_DEADBAND + (unsigned int)((long)pwm * (800 - MOTOR_DEADBAND) / 800) : 0u;
+}
+
+static void check_wheel(unsigned int p, enum motor_selection m, enum motor_speed_setting s)
+{
+    int duty = motor_speeds[s];
+
+    check(sim_motor[m].duty == pwm_for(duty), m == left ? "left PWM" : "right PWM", p,
+          sim_motor[m].duty, pwm_for(duty));
+    check(sim_motor[m].fwd == (duty >= 0) && sim_motor[m].fwd_cmp == (duty < 0),
+          m == left ? "left direction" : "right direction", p, sim_motor[m].fwd, duty >= 0);
+}
+
+static void check_patterns(void)
+{
+    unsigned int p, i, count, leds;
+    int moment, centroid;
+
+    control_mode = simple_curves;
+    for (p = 0; p < 32u; p++)
+    {
+        for (i = 0; i < SETTLE; i++)
+        {
+            feed((unsigned char)p);
+            check_sensors();
+        }
+        check(SeeLine.B == p, "SeeLine.B", p, SeeLine.B, p);
+        set_leds();
+        for (i = 0, leds = 0; i < 5u; i++) leds |= ((p >> (4 - i)) & 1u) << i;   // LED1 is Left
+        check(sim_leds == leds, "LEDs", p, sim_leds, leds);
+
+        for (i = 0; i < CROSS_MAX_TICKS + SLEW_TICKS; i++)
+        {
+            motor_control();
+            motor_output_update();
+        }
+        if (p == 0u)
+        {
+            check(motor_duty[left] == DUTY_BRAKE && motor_duty[right] == DUTY_BRAKE, "brake", p,
+                  motor_duty[left], DUTY_BRAKE);
+            check(sim_motor[left].duty == 800u && !sim_motor[left].fwd && !sim_motor[left].fwd_cmp
+                  && sim_motor[right].duty == 800u && !sim_motor[right].fwd && !sim_motor[right].fwd_cmp,
+                  "brake outputs", p, sim_motor[left].duty, 800);
+            continue;
+        }
+        for (i = 0, count = 0, moment = 0; i < 5u; i++)
+            if ((p >> (4 - i)) & 1u)
+            {
+                count++;
+                moment += 2 * (int)i - 4;       // left sensor -4 ... right sensor +4
+            }
+        centroid = moment / (int)count;
+        check(motor_duty[left] == motor_speeds[inner_wheel(centroid)], "left duty", p,
+              motor_duty[left], motor_speeds[inner_wheel(centroid)]);
+        check(motor_duty[right] == motor_speeds[inner_wheel(-centroid)], "right duty", p,
+              motor_duty[right], motor_speeds[inner_wheel(-centroid)]);
+        check_wheel(p, left, inner_wheel(centroid));
+        check_wheel(p, right, inner_wheel(-centroid));
+    }
+}
+
+// tracking pattern a for FEATURE_ARM_TICKS, then pattern b for CROSS_MIN_TICKS:
+// both wheels must be driving straight ahead
+static void check_hold(unsigned char a, unsigned char b)
+{
+    unsigned int i;
+
+    control_mode = simple_curves;
+    for (i = 0; i < SETTLE + FEATURE_ARM_TICKS; i++)
+    {
+        feed(a);
+        check_sensors();
+        motor_control();
+        motor_output_update();
+    }
+    for (i = 0; i < CROSS_MIN_TICKS; i++)
+    {
+        feed(b);
+        check_sensors();
+        motor_control();
+        motor_output_update();
+    }
+    check(line_feature != feature_none, "line_feature", b, line_feature, b ? feature_crossing : feature_gap);
+    check(motor_duty[left] == motor_speeds[fast], "hold left duty", b, motor_duty[left], motor_speeds[fast]);
+    check(motor_duty[right] == motor_speeds[fast], "hold right duty", b, motor_duty[right], motor_speeds[fast]);
+}
+
+// one control pass on a frame showing pattern
+static void pass(unsigned char pattern)
+{
+    feed(pattern);
+    check_sensors();
+    motor_control();
+    motor_output_update();
+}
+
+// the line is last seen under the centre right sensor (centroid +2) and then
+// lost: the wheel settings at the end of each stage of line_recovery.h
+static void check_recovery(void)
+{
+    static const struct { unsigned int tick; unsigned char left, right; } stages[] =
+    {
+        { RECOVER_HOLD - 1u,     fast, stop },         // the last pattern's command
+        { RECOVER_PIVOT - 1u,    fast, stop },         // a pivot, it already was one
+        { RECOVER_REVERSE - 1u,  fast, rev_slow },
+        { RECOVER_BACK - 1u,     fast, rev_fast },     // spin
+        { RECOVER_TIMEOUT - 1u,  rev_medium, rev_medium },   // back up
+        { RECOVER_TIMEOUT + 10u, PATTERN_BRAKE, PATTERN_BRAKE },
+    };
+    unsigned int i, tick = 0, s;
+    int want_left, want_right;
+
+    control_mode = simple_curves;
+    for (i = 0; i < SETTLE; i++)
+    {
+        feed(0x02u);
+        check_sensors();
+        motor_control();
+        motor_output_update();
+    }
+    for (s = 0; s < sizeof stages / sizeof stages[0]; s++)
+    {
+        for (; tick <= stages[s].tick; tick++)
+        {
+            feed(0u);
+            check_sensors();
+            motor_control();
+            motor_output_update();
+        }
+        want_left = stages[s].left == PATTERN_BRAKE ? DUTY_BRAKE : motor_speeds[stages[s].left];
+        want_right = stages[s].right == PATTERN_BRAKE ? DUTY_BRAKE : motor_speeds[stages[s].right];
+        check(motor_duty[left] == want_left, "recovery left duty", 0u, motor_duty[left], want_left);
+        check(motor_duty[right] == want_right, "recovery right duty", 0u, motor_duty[right], want_right);
+    }
+}
+
+// a 0b00100 frame is on the sensors (LED3) while LED_CODE_BOR (LED5) is shown
+static void check_led_code(void)
+{
+    unsigned int i, runs, flashes;
+    unsigned char last;
+
+    for (i = 0; i < SETTLE; i++)
+    {
+        feed(0x04u);
+        check_sensors();
+    }
+    led_code_show(LED_CODE_BOR, LED_CODE_SHOW_TICKS);
+    runs = (LED_CODE_SHOW_TICKS + LED_PERIOD_TICKS - 1u) / LED_PERIOD_TICKS;
+    for (i = 1, flashes = 0, last = sim_leds; i < runs; i++)
+    {
+        set_leds();
+        check(sim_leds == 0x11u || sim_leds == 0x12u, "status code", 0x04u, sim_leds, 0x11u);
+        if (sim_leds != last) flashes++;
+        last = sim_leds;
+    }
+    check(flashes >= LED_CODE_SHOW_TICKS / LED_CODE_HALF_TICKS - 1u, "status code flashes", 0x04u,
+          flashes, LED_CODE_SHOW_TICKS / LED_CODE_HALF_TICKS);
+    set_leds();
+    check(!led_code_showing && sim_leds == 0x04u, "LEDs after the status code", 0x04u, sim_leds, 0x04u);
+}
+
+// a centred frame (0b00100) is on the sensors, left from check_led_code()
+static void check_obstacle(void)
+{
+    unsigned int i, events = obstacle_events;
+
+    control_mode = simple_curves;
+    sim_ir = 3u;
+    for (i = 1; i < OBSTACLE_ON_SAMPLES; i++) obstacle_task();
+    check(obstacle_action == obstacle_none, "obstacle before the debounce", 0x04u, obstacle_action, obstacle_none);
+    obstacle_task();
+    motor_control();
+    check(obstacle_action == obstacle_stop && motor_duty[left] == DUTY_BRAKE && motor_duty[right] == DUTY_BRAKE,
+          "brake for an obstacle", 0x04u, motor_duty[left], DUTY_BRAKE);
+
+    sim_ir = 1u;
+    for (i = 0; i < OBSTACLE_CLEAR_SAMPLES; i++) obstacle_task();
+    for (i = 0; i < SLEW_TICKS; i++)
+    {
+        motor_control();
+        motor_output_update();
+    }
+    check(obstacle_action == obstacle_slow && motor_duty[left] == motor_speeds[fast] + OBSTACLE_SLOW_TRIM
+          && motor_duty[right] == motor_speeds[fast] + OBSTACLE_SLOW_TRIM, "slow for an obstacle on one side",
+          0x04u, motor_duty[left], motor_speeds[fast] + OBSTACLE_SLOW_TRIM);
+
+    sim_ir = 0u;
+    for (i = 0; i < OBSTACLE_CLEAR_SAMPLES; i++) obstacle_task();
+    for (i = 0; i < SLEW_TICKS; i++)
+    {
+        motor_control();
+        motor_output_update();
+    }
+    check(obstacle_action == obstacle_none && obstacle_events == events + 3u && motor_duty[left] == motor_speeds[fast],
+          "obstacle gone", 0x04u, motor_duty[left], motor_speeds[fast]);
+
+    // line recovery counts on through a stop, and a recovery command is slowed too
+    for (i = 0; i < SETTLE; i++) pass(0x02u);
+    sim_ir = 3u;
+    for (i = 0; i < OBSTACLE_ON_SAMPLES; i++) obstacle_task();
+    for (i = 0; i < RECOVER_PIVOT; i++) pass(0u);
+    check(line_lost_ticks == RECOVER_PIVOT - 1u, "line lost ticks while braked", 0u, line_lost_ticks,
+          RECOVER_PIVOT - 1u);   // the filter still shows the line on the first frame
+    sim_ir = 1u;
+    for (i = 0; i < OBSTACLE_CLEAR_SAMPLES; i++) obstacle_task();
+    for (i = 0; i < SLEW_TICKS; i++) pass(0u);   // still before RECOVER_REVERSE
+    check(motor_duty[left] == motor_speeds[fast] + OBSTACLE_SLOW_TRIM && motor_duty[right] == motor_speeds[rev_slow],
+          "recovery slowed for an obstacle", 0u, motor_duty[left], motor_speeds[fast] + OBSTACLE_SLOW_TRIM);
+    sim_ir = 0u;
+    for (i = 0; i < OBSTACLE_CLEAR_SAMPLES; i++) obstacle_task();
+    for (i = 0; i < SETTLE; i++) pass(0x04u);
+}
+
+#ifdef SUPERVISOR
+// one reset log write per reset, as on the robot
+static unsigned char reset(unsigned char cause)
+{
+    unsigned char warm = persist_reset(cause);
+
+    while (eeprom_pending())
+    {
+        sim_time_ns += SIM_EEPROM_WRITE_NS;
+        eeprom_task();
+    }
+    return warm;
+}
+
+// the state main() sets up is changed after each snapshot, as a reset would clear it
+static void check_persist(void)
+{
+    unsigned int threshold2 = sensor_threshold[2], i;
+
+    reset(reset_por);
+    control_mode = pid_steering;
+    line_last_pattern = 0x18u;
+    line_position = -300;
+    lap_count = 7u;
+    persist_task();
+    persist_task();
+    control_mode = simple_curves;
+    line_last_pattern = 0u;
+    line_position = 0;
+    lap_count = 0u;
+    sensor_threshold[2] = 1u;
+
+    check(reset(reset_wdt), "warm restart after a WDT reset", 0x18u, 0, 1);
+    persist_resume();
+    check(control_mode == pid_steering && line_last_pattern == 0x18u && line_position == -300
+          && lap_count == 7u && sensor_threshold[2] == threshold2, "state after the warm restart", 0x18u,
+          line_last_pattern, 0x18u);
+    for (i = 0; i < LAP_MARK_FRAMES; i++)   // the stripe holdoff does not start over
+    {
+        SeeLine.B = 0x1fu;
+        line_frame_new = 1;
+        lap_map_update();
+    }
+    check(lap_count == 8u, "stripe just after the warm restart", 0x1fu, lap_count, 8u);
+    persist_task();
+    check(reset(reset_bor) && reset_count[reset_wdt] == 1u && reset_count[reset_bor] == 1u,
+          "reset counts", 0x18u, reset_count[reset_wdt], 1u);
+    reset(reset_por);
+    check(!reset(reset_wdt), "no warm restart after a POR", 0x18u, 1, 0);
+
+    check(sim_eeprom[EE_RESET_LOG + 1u + reset_wdt] == 2u && sim_eeprom[EE_RESET_LOG + 1u + RESET_CAUSES] == reset_wdt,
+          "reset log", 0x18u, sim_eeprom[EE_RESET_LOG + 1u + reset_wdt], 2u);
+    control_mode = simple_curves;
+    line_last_pattern = 0u;
+}
+#endif
+
+static void check_set_motor_speed(void)
+{
+    static const struct { enum motor_speed_setting s; int modifier, want; } cases[] =
+    {
+        { fast, 0, 800 }, { fast, 100, 800 }, { fast, -100, 700 }, { rev_fast, -100, -800 },
+        { slow, 50, 700 }, { stop, -20, -20 }, { rev_slow, 1700, 800 },
+    };
+    unsigned int i, t;
+
+    for (i = 0; i < sizeof cases / sizeof cases[0]; i++)
+    {
+        set_motor_speed(right, cases[i].s, cases[i].modifier);
+        for (t = 0; t < SLEW_TICKS; t++) motor_output_update();
+        check(motor_duty[right] == cases[i].want, "set_motor_speed() duty", i, motor_duty[right], cases[i].want);
+    }
+
+    // a short brake keeps the duty, a long one ramps up again from 0
+    for (t = 0; t < 2u * MOTOR_BRAKE_HOLD; t += MOTOR_BRAKE_HOLD)
+    {
+        set_motor_speed(right, fast, 0);
+        for (i = 0; i < SLEW_TICKS; i++) motor_output_update();
+        motors_brake_all();
+        for (i = 0; i <= t; i++) motor_output_update();
+        set_motor_speed(right, fast, 0);
+        motor_output_update();
+        check(motor_duty[right] == (t ? MOTOR_SLEW : motor_speeds[fast]), "duty after a brake", t,
+              motor_duty[right], t ? MOTOR_SLEW : motor_speeds[fast]);
+    }
+}
+
+static unsigned char bench_pattern;
+
+static void bench_empty(void)
+{
+}
+
+static void bench_check_sensors(void)
+{
+    feed(bench_pattern);
+    bench_pattern = (unsigned char)((bench_pattern + 7u) & 31u);
+    check_sensors();
+}
+
+static void bench_motor_control(void)
+{
+    SeeLine.B = bench_pattern;
+    bench_pattern = (unsigned char)((bench_pattern + 7u) & 31u);
+    motor_control();
+}
+
+static void bench_set_motor_speed(void)
+{
+    set_motor_speed(left, (enum motor_speed_setting)(bench_pattern % 7u), bench_pattern);
+    bench_pattern = (unsigned char)((bench_pattern + 7u) & 31u);
+}
+
+// best of five runs of n calls, in ns per call
+static double time_calls(void (*fn)(void), unsigned long n)
+{
+    struct timespec a, b;
+    double best = 1e30, ns;
+    unsigned long i;
+    int run;
+
+    for (run = 0; run < 5; run++)
+    {
+        clock_gettime(CLOCK_MONOTONIC, &a);
+        for (i = 0; i < n; i++) fn();
+        clock_gettime(CLOCK_MONOTONIC, &b);
+        ns = ((b.tv_sec - a.tv_sec) * 1e9 + (b.tv_nsec - a.tv_nsec)) / n;
+        if (ns < best) best = ns;
+    }
+    return best;
+}
+
+int main(int argc, char **argv)
+{
+    unsigned long n = 1000000ul;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:")) != -1)
+    {
+        if (opt != 'n')
+        {
+            fprintf(stderr, "usage: %s [-n calls]\n", argv[0]);
+            return 2;
+        }
+        n = strtoul(optarg, NULL, 0);
+    }
+    memset(sim_eeprom, 0xff, sizeof sim_eeprom);
+    initialization();
+    calibration_init();
+
+    check_patterns();
+    check_hold(0x04u, 0x1cu);
+    check_hold(0x0cu, 0u);
+    check_recovery();
+    check_led_code();
+    check_obstacle();
+#ifdef SUPERVISOR
+    check_persist();
+#endif
+    check_set_motor_speed();
+    printf("%s: 32 sensor patterns, crossing and gap holds, line recovery, status codes, obstacles and set_motor_speed(), %u failures\n", failures ? "FAIL" : "ok", failures);
+
+    printf("ns per call on this host (best of 5 x %lu calls, call overhead %.1f ns)\n", n,
+           time_calls(bench_empty, n));
+    printf("  check_sensors()         %6.1f  (a new frame every call)\n", time_calls(bench_check_sensors, n));
+    printf("  set_leds()              %6.1f\n", time_calls(set_leds, n));
+    control_mode = simple_curves;
+    printf("  motor_control() simple  %6.1f\n", time_calls(bench_motor_control, n));
+    control_mode = pid_steering;
+    printf("  motor_control() pid     %6.1f\n", time_calls(bench_motor_control, n));
+    printf("  set_motor_speed()       %6.1f\n", time_calls(bench_set_motor_speed, n));
+    printf("  motor_output_update()   %6.1f\n", time_calls(motor_output_update, n));
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,229 @@
+// plant.c
+//   Differential drive model of the sumovore on a circular track, or a
+//   stadium (two straights joined by half circles) with a start/finish
+//   stripe across the middle of the first straight, or a raster track
+//   image (track.h).
+//   Wheel speeds follow the commanded duty with a first order lag, the five
+//   reflective sensors sit in a row ahead of the axle and report a 10 bit
+//   value that rises as more of their spot covers the (dark) line.
+//   The battery drains at a steady rate and sags under the motor current;
+//   the wheel speed a duty gives is proportional to its voltage.
+//   rev. Oct. 17, 2026 battery voltage (battery.h)
+//   rev. Oct. 17, 2026 raster tracks, lap times and off line events
+//   rev. Oct. 17, 2026 motor deadband
+//   rev. Oct. 17, 2026 stadium track with start/finish stripe
+//   rev. Oct. 17, 2026 sensor noise set by plant_config
+//   rev. Oct. 17, 2026 sensor_spread gives each sensor its own floor and line levels
+//   rev. Oct. 17, 2026 first version
+
+#include <math.h>
+#include "sumovore.h"
+#include "sim.h"
+#include "track.h"
+#include "battery.h"
+
+#define WHEEL_BASE_MM     100.0
+#define SENSOR_AHEAD_MM    60.0   // sensor row ahead of the wheel axle
+#define SENSOR_PITCH_MM    18.0   // spacing between neighbouring sensors
+#define SENSOR_SPOT_MM      6.0   // radius of the area one sensor sees
+#define LINE_WIDTH_MM      19.0   // 3/4 inch electrical tape
+#define STRIPE_HALF_MM     60.0   // the start/finish stripe reaches this far either side
+
+#define MOTOR_TAU_S         0.060 // driven wheel time constant
+#define BRAKE_TAU_S         0.025 // dead short across the motor terminals
+#define COAST_TAU_S         0.250 // enable low, motor free wheeling
+
+#define ADC_FLOOR         150.0   // reading over the white floor
+#define ADC_LINE          880.0   // reading fully over the line
+#define ON_LINE             0.3   // coverage (or darkness) a sensor needs to count as on the line
+#define GATE_HALF_MM      150.0   // the start line reaches this far either side of the start pose
+#define OFFLINE_EVENT_S   0.010   // a line loss shorter than this is not counted as an event
+#define GATE_ARM_MM       500.0   // and only counts again once the robot has been this far from it
+#define SAG_MV            400.0   // battery voltage drop with both motors at full duty
+
+struct plant_state plant;
+
+static struct plant_config config;
+static double last_angle;
+static double last_gate;         // distance of the axle ahead of the start line
+static double last_lap_s;        // plant.time_s at the last start line crossing
+static int gate_armed;
+static double offline_run_s;     // how long the line has been lost for
+static unsigned int noise_state;
+static const double mismatch[5] = { 1.0, -0.5, 0.2, -1.0, 0.6 };  // scaled by sensor_spread
+
+void plant_init(const struct plant_config *cfg)
+{
+    config = *cfg;
+    noise_state = cfg->seed ? cfg->seed : 1u;
+
+    // circle centre at (0, R); start on the line heading along +x so the
+    // robot travels counter clockwise (a continuous left curve)
+    plant.x_mm = 0.0;
+    plant.y_mm = 0.0;
+    plant.heading_rad = 0.0;
+    if (config.track)
+    {
+        plant.x_mm = config.track->start_x_mm;
+        plant.y_mm = config.track->start_y_mm;
+        plant.heading_rad = config.track->start_heading_rad;
+    }
+    plant.v_left_mm_s = 0.0;
+    plant.v_right_mm_s = 0.0;
+    plant.distance_mm = 0.0;
+    plant.laps = 0.0;
+    plant.offline_s = 0.0;
+    plant.offline_events = 0;
+    plant.time_s = 0.0;
+    plant.lap_count = 0;
+    plant.lap_best_s = 0.0;
+    plant.lap_total_s = 0.0;
+    if (config.battery_mv <= 0.0) config.battery_mv = SIM_BATTERY_MV;
+    plant.battery_mv = config.battery_mv;
+    last_angle = atan2(plant.y_mm - config.track_radius_mm, plant.x_mm);
+    last_gate = 0.0;
+    last_lap_s = 0.0;
+    gate_armed = 0;
+    offline_run_s = 0.0;
+}
+
+// signed distance from (x, y) to the centre of the line. The track is every
+// point track_radius_mm from the segment joining the two curve centres
+// (-L/2, R) and (L/2, R), L = straight_mm; L = 0 gives the circle.
+static double line_offset(double x, double y)
+{
+    double half = config.straight_mm / 2.0, cx = x, dy = y - config.track_radius_mm;
+
+    if (cx > half) cx -= half;
+    else if (cx < -half) cx += half;
+    else cx = 0.0;
+    return sqrt(cx * cx + dy * dy) - config.track_radius_mm;
+}
+
+static double cover(double offset)
+{
+    double c = (LINE_WIDTH_MM / 2.0 + SENSOR_SPOT_MM - fabs(offset)) / (2.0 * SENSOR_SPOT_MM);
+
+    if (c < 0.0) return 0.0;
+    if (c > 1.0) return 1.0;
+    return c;
+}
+
+// fraction of a sensor spot covering the line (or the start/finish stripe)
+static double sensor_coverage(int sensor)
+{
+    double lateral = (2 - sensor) * SENSOR_PITCH_MM;   // sensor 0 (left) is +2 pitches to the left
+    double c = cos(plant.heading_rad), s = sin(plant.heading_rad);
+    double x = plant.x_mm + SENSOR_AHEAD_MM * c - lateral * s;
+    double y = plant.y_mm + SENSOR_AHEAD_MM * s + lateral * c;
+    double on_line, on_stripe;
+
+    if (config.track) return track_darkness(config.track, x, y, SENSOR_SPOT_MM);
+    on_line = cover(line_offset(x, y));
+    if (config.straight_mm > 0.0 && fabs(y) < STRIPE_HALF_MM)
+    {
+        on_stripe = cover(x);
+        if (on_stripe > on_line) return on_stripe;
+    }
+    return on_line;
+}
+
+unsigned int plant_adc(unsigned char channel)
+{
+    double value, scale;
+
+    if (channel == BATTERY_CH)   // through the divider, against the regulated 5 V
+    {
+        value = plant.battery_mv * 1023.0 / BATTERY_FULL_SCALE_MV;
+        return value > 1023.0 ? 1023u : (unsigned int)value;
+    }
+    scale = 1.0 + config.sensor_spread * mismatch[channel];
+    noise_state = noise_state * 1103515245u + 12345u;
+    value = ADC_FLOOR * scale + (ADC_LINE - ADC_FLOOR) * scale * sensor_coverage(channel)
+          + config.noise * ((double)((noise_state >> 16) & 0x7fffu) / 32767.0 - 0.5);
+    if (value < 0.0) value = 0.0;
+    if (value > 1023.0) value = 1023.0;
+    return (unsigned int)value;
+}
+
+// below deadband duty the motor does not turn, above it the speed rises
+// linearly to v_max at 800 (at BATTERY_NOMINAL_MV, in proportion to the
+// battery voltage)
+static double wheel_step(double v, const struct sim_motor *m, double dt_s)
+{
+    double target = 0.0, tau = COAST_TAU_S, drive = 0.0;
+
+    if (m->duty > config.deadband)
+        drive = config.v_max_mm_s * (m->duty - config.deadband) / (800.0 - config.deadband)
+              * plant.battery_mv / BATTERY_NOMINAL_MV;
+    if (m->duty != 0u)
+    {
+        if (m->fwd && !m->fwd_cmp) target = drive, tau = MOTOR_TAU_S;
+        else if (!m->fwd && m->fwd_cmp) target = -drive, tau = MOTOR_TAU_S;
+        else tau = BRAKE_TAU_S;   // both lines equal: terminals shorted
+    }
+    return v + (target - v) * (dt_s / (tau + dt_s));
+}
+
+// the axle crossing the start line forward ends a lap, the first lap is
+// timed from the standing start. A robot that has lost the line and wanders
+// back and forth over the start line only counts once.
+static void start_line(void)
+{
+    double c = cos(config.track->start_heading_rad), s = sin(config.track->start_heading_rad);
+    double dx = plant.x_mm - config.track->start_x_mm, dy = plant.y_mm - config.track->start_y_mm;
+    double ahead = dx * c + dy * s, across = -dx * s + dy * c, lap_s;
+
+    if (dx * dx + dy * dy > GATE_ARM_MM * GATE_ARM_MM) gate_armed = 1;
+    if (gate_armed && last_gate < 0.0 && ahead >= 0.0 && fabs(across) < GATE_HALF_MM)
+    {
+        gate_armed = 0;
+        lap_s = plant.time_s - last_lap_s;
+        if (plant.lap_best_s == 0.0 || lap_s < plant.lap_best_s) plant.lap_best_s = lap_s;
+        plant.lap_count++;
+        plant.lap_total_s = plant.time_s;
+        last_lap_s = plant.time_s;
+        plant.laps = plant.lap_count;
+    }
+    last_gate = ahead;
+}
+
+void plant_step(double dt_s)
+{
+    double v, omega, angle, d;
+    int sensor, on_line = 0;
+
+    plant.battery_mv = config.battery_mv - config.battery_drain_mv_s * plant.time_s
+                     - SAG_MV * (sim_motor[left].duty + sim_motor[right].duty) / 1600.0;
+    plant.v_left_mm_s = wheel_step(plant.v_left_mm_s, &sim_motor[left], dt_s);
+    plant.v_right_mm_s = wheel_step(plant.v_right_mm_s, &sim_motor[right], dt_s);
+
+    v = (plant.v_left_mm_s + plant.v_right_mm_s) / 2.0;
+    omega = (plant.v_right_mm_s - plant.v_left_mm_s) / WHEEL_BASE_MM;
+    plant.x_mm += v * cos(plant.heading_rad) * dt_s;
+    plant.y_mm += v * sin(plant.heading_rad) * dt_s;
+    plant.heading_rad += omega * dt_s;
+    plant.distance_mm += fabs(v) * dt_s;
+
+    plant.time_s += dt_s;
+
+    if (config.track) start_line();
+    else
+    {
+        angle = atan2(plant.y_mm - config.track_radius_mm, plant.x_mm);
+        d = angle - last_angle;
+        if (d > M_PI) d -= 2.0 * M_PI;
+        if (d < -M_PI) d += 2.0 * M_PI;
+        plant.laps += d / (2.0 * M_PI);
+        last_angle = angle;
+    }
+
+    for (sensor = 0; sensor < 5; sensor++) if (sensor_coverage(sensor) > ON_LINE) on_line = 1;
+    if (on_line) offline_run_s = 0.0;
+    else
+    {
+        plant.offline_s += dt_s;
+        if (offline_run_s < OFFLINE_EVENT_S && offline_run_s + dt_s >= OFFLINE_EVENT_S) plant.offline_events++;
+        offline_run_s += dt_s;
+    }
+}
@@ -0,0 +1,270 @@
+// replay.c
+//   Replays a flight recorder capture (record.h) through the unchanged
+//   control loop and compares the motor duties with the recorded ones.
+//
+//   usage: replay [-n diffs_to_print] capture.bin
+//
+//   The capture is what the robot (or sumovore_sim -u) sent on the USART
+//   with RECORD defined; records are found by their sync byte and CRC, so
+//   printf text and telemetry frames in between are skipped. The settings
+//   and data EEPROM records set the firmware up as main() did, then each
+//   pass record sets sched_time, hands its sensor frame to check_sensors()
+//   in place of the ADC scan (this program provides adc_scan_read()) and
+//   runs the control task; battery records set the duty scaling that
+//   battery_task() had measured (battery.h) and obstacle records the
+//   events of obstacle_task() (obstacle.h). Resume records put back the state
+//   a warm restart restored (persist.h) before the first pass. Built from the same sources the capture was
+//   made with, every duty matches; built with a changed motor_control.c it
+//   shows where the new controller would have done something else.
+//   Replay stops at the first sequence gap (records dropped on the robot),
+//   as the control state after it cannot be known.
+//   Exit status 0 if every duty matched, 1 if not, 2 for a bad capture.
+//   rev. Oct. 17, 2026 warm restart records
+//   rev. Oct. 17, 2026 obstacle records
+//   rev. Oct. 17, 2026 battery records
+//   rev. Oct. 17, 2026 first version
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "sumovore.h"
+#include "motor_control.h"
+#include "pid_steer.h"
+#include "adc_scan.h"
+#include "sched.h"
+#include "tasks.h"
+#include "calibration.h"
+#include "lap_map.h"
+#include "record.h"
+#include "telem_frame.h"
+#include "battery.h"
+#include "obstacle.h"
+#include "persist.h"
+#include "sim.h"
+
+// check_sensors() reads its frames from here instead of adc_scan.c
+static unsigned int replay_adc[LINE_SENSORS];
+static unsigned char replay_count;
+
+void adc_scan_start(void)
+{
+}
+
+void adc_scan_isr(void)
+{
+}
+
+unsigned char adc_scan_read(unsigned int *dest)
+{
+    unsigned char i;
+
+    for (i = 0; i < LINE_SENSORS; i++) dest[i] = replay_adc[i];
+    return replay_count;
+}
+
+// the frames come whole from the capture
+void adc_scan_focus(unsigned char sensor)
+{
+}
+
+// battery_task() gets no readings here, the REC_BATTERY records set
+// what it would have
+unsigned char adc_scan_battery(unsigned int *dest)
+{
+    *dest = 0;
+    return 0;
+}
+
+static int get16(const unsigned char *p)
+{
+    return (int)(short)(p[0] | (p[1] << 8));
+}
+
+static int duty12(unsigned int v)
+{
+    return (v & 0x800u) ? (int)v - 0x1000 : (int)v;
+}
+
+static double wall_seconds(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+int main(int argc, char **argv)
+{
+    unsigned char *buf, *r, ir = 0;
+    unsigned int expect_seq = 0, i, n;
+    unsigned long passes = 0, diffs = 0, show = 10, skipped = 0, first_pass = 0, passes_total = 0;
+    long size, pos;
+    int opt, have_settings = 0, have_seq = 0, duty[2], gap = 0;
+#ifdef SUPERVISOR
+    static unsigned char resume_image[PERSIST_IMAGE_SIZE];
+    int resumed = 0;
+#endif
+    double wall;
+    FILE *f;
+
+    while ((opt = getopt(argc, argv, "n:")) != -1)
+    {
+        if (opt == 'n') show = strtoul(optarg, NULL, 0);
+        else goto usage;
+    }
+    if (optind != argc - 1) goto usage;
+    if (!(f = fopen(argv[optind], "rb")) || fseek(f, 0, SEEK_END) || (size = ftell(f)) < 0)
+    {
+        perror(argv[optind]);
+        return 2;
+    }
+    rewind(f);
+    if (!(buf = malloc(size + 1)) || fread(buf, 1, size, f) != (size_t)size)
+    {
+        perror(argv[optind]);
+        return 2;
+    }
+    fclose(f);
+
+    // first the start up records: the data EEPROM and the settings
+    memset(sim_eeprom, 0xff, sizeof sim_eeprom);
+    for (pos = 0; pos + (long)REC_SIZE <= size; pos++)
+    {
+        r = buf + pos;
+        if (r[0] != REC_SYNC || telem_crc8(r + 1, REC_SIZE - 2u) != r[REC_SIZE - 1u]) continue;
+        if (r[1] == REC_PASS) break;
+        if (r[1] == REC_SETTINGS)
+        {
+            if (r[3] != REC_VERSION)
+            {
+                fprintf(stderr, "%s: recorder version %u, this replay reads %u\n", argv[optind], r[3], REC_VERSION);
+                return 2;
+            }
+            have_settings = 1;
+        }
+        else if (r[1] == REC_EEPROM)
+            for (i = 0; i < r[4] && i < REC_EEPROM_BYTES && r[3] + i < SIM_EEPROM_SIZE; i++)
+                sim_eeprom[r[3] + i] = r[5 + i];
+        pos += REC_SIZE - 1u;
+    }
+    if (!have_settings)
+    {
+        fprintf(stderr, "%s: no recorder settings record, was the firmware built with RECORD?\n", argv[optind]);
+        return 2;
+    }
+
+    initialization();   // as main() does, then the settings main() had made
+    for (pos = 0; pos + (long)REC_SIZE <= size; pos++)
+    {
+        r = buf + pos;
+        if (r[0] != REC_SYNC || telem_crc8(r + 1, REC_SIZE - 2u) != r[REC_SIZE - 1u]) continue;
+        if (r[1] == REC_SETTINGS)
+        {
+            control_mode = (enum control_mode)r[4];
+            lap_learning = r[5];
+            ir = r[6];
+            threshold = (unsigned int)get16(r + 7);
+            pid.kp = get16(r + 9);
+            pid.ki = get16(r + 11);
+            pid.kd = get16(r + 13);
+        }
+        else if (r[1] == REC_SPEEDS)
+            for (i = 0, n = 3; i < 7u; i++)
+            {
+                if (i == stop) continue;
+                motor_speeds[i] = get16(r + n);
+                n += 2u;
+            }
+        else if (r[1] == REC_RESUME)
+        {
+#ifdef SUPERVISOR
+            for (i = 0; i < REC_RESUME_BYTES && r[3] + i < PERSIST_IMAGE_SIZE; i++) resume_image[r[3] + i] = r[4 + i];
+            resumed = 1;
+#else
+            fprintf(stderr, "%s: a warm restart capture, build replay with SUPERVISOR=1\n", argv[optind]);
+            return 2;
+#endif
+        }
+        else if (r[1] == REC_PASS) break;
+        pos += REC_SIZE - 1u;
+    }
+    sim_ir = ir;
+    calibration_init();
+    lap_map_init();
+    sim_ir = 0;
+#ifdef SUPERVISOR
+    if (resumed) persist_apply(resume_image);   // as persist_resume() did on the robot
+#endif
+
+    wall = wall_seconds();
+    for (pos = 0; pos + (long)REC_SIZE <= size; pos++)
+    {
+        r = buf + pos;
+        if (r[0] != REC_SYNC || telem_crc8(r + 1, REC_SIZE - 2u) != r[REC_SIZE - 1u])
+        {
+            skipped++;
+            continue;
+        }
+        pos += REC_SIZE - 1u;
+        if (have_seq && r[2] != (unsigned char)expect_seq)
+        {
+            gap = 1;
+            break;
+        }
+        have_seq = 1;
+        expect_seq = r[2] + 1u;
+        if (r[1] == REC_BATTERY)
+        {
+            battery_mv = (unsigned int)get16(r + 3);
+            battery_scale = (unsigned int)get16(r + 5);
+            battery_low = r[7];
+        }
+        if (r[1] == REC_OBSTACLE)
+        {
+            obstacle_seen = r[3];
+            obstacle_action = r[4];
+            obstacle_events = (unsigned int)get16(r + 5);
+        }
+        if (r[1] != REC_PASS) continue;
+        if (!passes) first_pass = (unsigned int)get16(r + 3) & 0xffffu;
+
+        sched_time = (unsigned int)get16(r + 3);
+        for (i = 0; i < 4u; i++) replay_adc[i] = r[5 + i] | (((r[10] >> (2u * i)) & 3u) << 8);
+        replay_adc[4] = r[9] | ((r[11] & 3u) << 8);
+        if (r[11] & REC_NEW_FRAME) replay_count++;
+        tasks[task_control].run();
+
+        duty[left] = duty12(r[12] | ((r[13] & 0x0fu) << 8));
+        duty[right] = duty12((r[13] >> 4) | (r[14] << 4));
+        if (motor_duty[left] != duty[left] || motor_duty[right] != duty[right])
+        {
+            if (diffs < show)
+                printf("pass %lu (tick %u): duty %d %d, recorded %d %d\n", passes, sched_time,
+                       motor_duty[left], motor_duty[right], duty[left], duty[right]);
+            diffs++;
+        }
+        passes++;
+    }
+    wall = wall_seconds() - wall;
+    for (; pos + (long)REC_SIZE <= size; pos++)     // what the gap cost
+        if (buf[pos] == REC_SYNC && buf[pos + 1] == REC_PASS
+            && telem_crc8(buf + pos + 1, REC_SIZE - 2u) == buf[pos + REC_SIZE - 1u])
+        {
+            passes_total++;
+            pos += REC_SIZE - 1u;
+        }
+
+    if (gap) printf("sequence gap after pass %lu (records dropped on the robot), %lu passes not replayed\n",
+                    passes, passes_total);
+    printf("%lu passes from tick %lu (%.3f s) replayed in %.3f s (%.0fx real time), %lu bytes skipped\n",
+           passes, first_pass, passes * SCHED_TICK_US * 1e-6, wall,
+           wall > 0.0 ? passes * SCHED_TICK_US * 1e-6 / wall : 0.0, skipped);
+    printf("%lu passes with different duties\n", diffs);
+    return diffs ? 1 : 0;
+
+usage:
+    fprintf(stderr, "usage: %s [-n diffs_to_print] capture.bin\n", argv[0]);
+    return 2;
+}
@@ -0,0 +1,91 @@
+// sim.h
+//   Shared state of the Linux simulator build of the sumovore firmware.
+//   hal_sim.c implements hal.h on top of this, plant.c models the robot on
+//   the track and sim_main.c runs the unchanged control loop against both.
+//   rev. Oct. 17, 2026 battery voltage
+//   rev. Oct. 17, 2026 raster tracks
+//   rev. Oct. 17, 2026 data EEPROM, IR detectors and sensor mismatch
+//   rev. Oct. 17, 2026 first version
+
+#ifndef SIM_H
+#define SIM_H
+
+#include <stdio.h>
+
+struct track;
+
+#define SIM_ADC_CONVERSION_NS  62000ul  // 20 TAD acquisition + 11 TAD conversion,
+                                        //   TAD = 64 Tosc = 2 us at 32 MHz
+#define SIM_ADC_ISR_NS         12000ul  // about 100 instruction cycles in low_isr()
+#define SIM_TICK_ISR_NS         6000ul  // Timer0 tick through low_isr()
+#if defined(TELEMETRY) || defined(RECORD)
+#define SIM_UART_BYTE_NS       20000ul  // 10 bits at 500000 baud
+#else
+#define SIM_UART_BYTE_NS       85000ul  // 10 bits at 117647 baud
+#endif
+#define SIM_UART_ISR_NS         4000ul
+#define SIM_EEPROM_WRITE_NS  4000000ul  // one data EEPROM byte
+#define SIM_EEPROM_SIZE          256u
+#define SIM_BATTERY_MV          6000.0  // a charged pack of four AA cells
+
+struct sim_motor
+{
+    unsigned int duty;        // as written to SetDCPWMx(), 0 to 800
+    unsigned char fwd;        // LmotorGoFwd / RmotorGoFwd
+    unsigned char fwd_cmp;    // LmotorGoFwdCmp / RmotorGoFwdCmp
+};
+
+extern struct sim_motor sim_motor[2];   // indexed by enum motor_selection
+extern unsigned char sim_leds;          // last value given to hal_set_leds()
+extern unsigned long long sim_time_ns;  // simulated time since initialization()
+extern FILE *sim_uart;                  // bytes sent by the USART go here (NULL: dropped)
+extern unsigned char sim_eeprom[SIM_EEPROM_SIZE];  // data EEPROM, 0xff when erased
+extern unsigned char sim_ir;            // what hal_ir_detect() returns
+extern unsigned long long sim_frame_ns[LINE_SENSORS];  // when each reading of the frame
+                                        //   adc_scan_read() returns was converted
+
+void sim_advance(unsigned long ns);
+                 // runs ns of main line code: moves simulated time and the plant on
+                 // and calls the interrupt handlers that fall due on the way (each
+                 // one holds the main line off for its own run time)
+
+struct plant_config
+{
+    double track_radius_mm;   // the track is a circle of this radius ...
+    double straight_mm;       //   ... or, if this is not 0, a stadium: two straights of
+                              //   this length joined by half circles, with a start/finish
+                              //   stripe across the middle of the first straight
+    double v_max_mm_s;        // wheel surface speed at 100% duty
+    double deadband;          // PWM duty (of 800) the motors need to start turning
+    unsigned int seed;        // sensor noise
+    double noise;             // sensor noise, ADC counts peak to peak
+    double sensor_spread;     // 0: identical sensors, 0.2: floor and line readings
+                              //   differ by up to 20% from sensor to sensor
+    const struct track *track;  // if not NULL the robot runs on this image instead
+    double battery_mv;        // pack voltage at the start, 0 for SIM_BATTERY_MV; the
+    double battery_drain_mv_s;  //   motors reach v_max_mm_s at BATTERY_NOMINAL_MV
+};
+
+void plant_init(const struct plant_config *cfg);
+void plant_step(double dt_s);
+unsigned int plant_adc(unsigned char channel);  // AN0 (left) ... AN4 (right), AN7 the battery
+
+struct plant_state
+{
+    double x_mm, y_mm, heading_rad;
+    double v_left_mm_s, v_right_mm_s;
+    double distance_mm;
+    double laps;              // signed revolutions around the track centre (start line
+                              // crossings on a raster track)
+    double offline_s;         // time with no sensor over the line
+    unsigned long offline_events;   // times the line was lost
+    double time_s;
+    unsigned int lap_count;   // raster track only: completed laps, their best time
+    double lap_best_s;        // and the time the last one ended
+    double lap_total_s;
+    double battery_mv;        // pack voltage now, down by SAG_MV at full duty on both motors
+};
+
+extern struct plant_state plant;
+
+#endif // SIM_H
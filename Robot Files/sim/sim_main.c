@@ -0,0 +1,282 @@
+// sim_main.c
+//   Runs the firmware control loop (the task table in tasks.c through
+//   sched_run(), as main() does) against the simulated hardware in hal_sim.c
+//   and plant.c, as fast as the host allows, and prints a summary of the run.
+//
+//   usage: sumovore_sim [-t seconds] [-r track_radius_mm] [-S straight_mm] [-v v_max_mm_s]
+//                       [-d deadband] [-s seed] [-m simple|pid] [-o trace.csv] [-u usart.bin]
+//                       [-n noise] [-k sensor_spread] [-e eeprom.bin] [-c] [-L]
+//                       [-T file.track] [-b] [-V mv[:drain_mv_per_s]] [-O s[:for_s[:sides]]]
+//     -d  PWM duty the simulated motors need to start turning (96 of 800)
+//     -S  stadium track with straights of this length and a start/finish stripe
+//     -L  lap learning (lap_map.h)
+//     -e  data EEPROM image, loaded at the start (if it exists) and saved at the end
+//     -c  both IR detectors blocked at power up: run the calibration sweep
+//     -T  run on a raster track (track.h) instead of the circle or stadium
+//     -b  print a single benchmark line (see bench.sh) instead of the summary
+//     -V  battery voltage at the start (SIM_BATTERY_MV) and how fast it drops
+//     -O  an obstacle in front from s seconds on, for for_s seconds (1), seen by
+//         the IR detectors in sides (1 left, 2 right, 3 both, the default)
+//   rev. Oct. 17, 2026 sensor to motor latency histogram in the summary (make INSTRUMENT=1)
+//   rev. Oct. 17, 2026 age of the reading nearest the line in the summary
+//   rev. Oct. 17, 2026 -O obstacle, obstacle line in the summary
+//   rev. Oct. 17, 2026 -V battery voltage and drain, battery line in the summary
+//   rev. Oct. 17, 2026 crossings and gaps driven through in the summary
+//   rev. Oct. 17, 2026 -T raster tracks, -b benchmark line, control pass host time
+//   rev. Oct. 17, 2026 -d motor deadband
+//   rev. Oct. 17, 2026 stadium track and lap learning options
+//   rev. Oct. 17, 2026 SeeLine change count in the summary, -n sensor noise
+//   rev. Oct. 17, 2026 calibration sweep, EEPROM image and sensor mismatch options
+//   rev. Oct. 17, 2026 first version
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "sumovore.h"
+#include "motor_control.h"
+#include "line_position.h"
+#include "sched.h"
+#include "tasks.h"
+#include "calibration.h"
+#include "lap_map.h"
+#include "line_feature.h"
+#include "battery.h"
+#include "obstacle.h"
+#include "record.h"
+#include "sim.h"
+#include "track.h"
+
+static double wall_seconds(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// the control task runs through this so the host time it takes can be
+// reported, a figure to compare controller changes by (the simulator gives
+// main line code no simulated time, so it cannot tell the PIC's budget)
+static void (*control_task)(void);
+static double control_wall;
+
+static void timed_control(void)
+{
+    double t = wall_seconds();
+
+    control_task();
+    control_wall += wall_seconds() - t;
+}
+
+#ifdef INSTRUMENT
+// the firmware's latency histogram (instrument.h) in microseconds: median and
+// 99th percentile to the top of their bucket, one line per bucket in use
+static void print_latency(void)
+{
+    const double us = (1u << LATENCY_BUCKET_SHIFT) * 0.125;   // bucket width, 125 ns cycles
+    unsigned long n = 0, run = 0;
+    unsigned int i, median = 0, p99 = 0;
+
+    for (i = 0; i < LATENCY_BUCKETS; i++) n += latency_hist[i];
+    if (!n) return;
+    for (i = 0; i < LATENCY_BUCKETS; i++)
+    {
+        run += latency_hist[i];
+        if (!median && run * 2 >= n) median = i + 1;
+        if (!p99 && run * 100 >= n * 99) p99 = i + 1;
+    }
+    printf("latency       %lu frames, median %.0f us, 99%% %.0f us, max %.0f us: first conversion to PWM write\n",
+           n, median * us, p99 * us, latency_max * 0.125);
+    for (i = 0; i < LATENCY_BUCKETS; i++)
+        if (latency_hist[i])
+            printf("  %5.0f us %7lu  %5.1f%%\n", i * us, latency_hist[i], latency_hist[i] * 100.0 / n);
+}
+#endif
+
+int main(int argc, char **argv)
+{
+    struct plant_config cfg =
+    {
+        .track_radius_mm = 400.0, .straight_mm = 0.0, .v_max_mm_s = 600.0, .deadband = 96.0,
+        .seed = 1u, .noise = 12.0, .sensor_spread = 0.0, .track = NULL,
+        .battery_mv = 0.0, .battery_drain_mv_s = 0.0   // SIM_BATTERY_MV, no drain
+    };
+    struct track track;
+    double run_s = 30.0, wall, control_ns;
+    const char *trace_path = NULL, *uart_path = NULL, *eeprom_path = NULL, *track_path = NULL;
+    char *colon;
+    FILE *trace = NULL, *f;
+    unsigned char ir_at_start = 0, last_seeline = 0, bench = 0, obstacle_sides = 3u;
+    double obstacle_s = -1.0, obstacle_for_s = 1.0, reaction_s = -1.0;
+    double age_ns, age_sum_ns = 0.0, age_max_ns = 0.0;
+    unsigned long ages = 0;
+    unsigned int c;
+    unsigned long seeline_changes = 0;
+    unsigned long long end_ns;
+    int opt, i;
+
+    while ((opt = getopt(argc, argv, "t:r:S:v:d:s:m:o:u:n:k:e:cLT:bV:O:")) != -1)
+    {
+        switch (opt)
+        {
+        case 't': run_s = atof(optarg); break;
+        case 'r': cfg.track_radius_mm = atof(optarg); break;
+        case 'S': cfg.straight_mm = atof(optarg); break;
+        case 'v': cfg.v_max_mm_s = atof(optarg); break;
+        case 'd': cfg.deadband = atof(optarg); break;
+        case 's': cfg.seed = (unsigned int)strtoul(optarg, NULL, 0); break;
+        case 'm': control_mode = strcmp(optarg, "pid") ? simple_curves : pid_steering; break;
+        case 'o': trace_path = optarg; break;
+        case 'u': uart_path = optarg; break;
+        case 'n': cfg.noise = atof(optarg); break;
+        case 'k': cfg.sensor_spread = atof(optarg); break;
+        case 'e': eeprom_path = optarg; break;
+        case 'c': ir_at_start = 3u; break;
+        case 'L': lap_learning = 1; break;
+        case 'T': track_path = optarg; break;
+        case 'b': bench = 1; break;
+        case 'V':
+            cfg.battery_mv = atof(optarg);
+            if ((colon = strchr(optarg, ':'))) cfg.battery_drain_mv_s = atof(colon + 1);
+            break;
+        case 'O':
+            obstacle_s = atof(optarg);
+            if ((colon = strchr(optarg, ':')))
+            {
+                obstacle_for_s = atof(colon + 1);
+                if ((colon = strchr(colon + 1, ':'))) obstacle_sides = (unsigned char)(atoi(colon + 1) & 3);
+            }
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-t seconds] [-r track_radius_mm] [-S straight_mm] [-v v_max_mm_s] [-d deadband] [-s seed] [-m simple|pid] [-o trace.csv] [-u usart.bin] [-n noise] [-k sensor_spread] [-e eeprom.bin] [-c] [-L] [-T file.track] [-b] [-V mv[:drain_mv_per_s]] [-O s[:for_s[:sides]]]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (track_path)
+    {
+        if (track_load(&track, track_path)) return 1;
+        cfg.track = &track;
+    }
+    if (trace_path && !(trace = fopen(trace_path, "w")))
+    {
+        perror(trace_path);
+        return 1;
+    }
+    if (uart_path && !(sim_uart = fopen(uart_path, "wb")))
+    {
+        perror(uart_path);
+        return 1;
+    }
+    if (trace) fprintf(trace, "t_s,x_mm,y_mm,heading_rad,seeline,line_position,line_found,duty_left,fwd_left,duty_right,fwd_right\n");
+
+    memset(sim_eeprom, 0xff, sizeof sim_eeprom);
+    if (eeprom_path && (f = fopen(eeprom_path, "rb")))
+    {
+        if (fread(sim_eeprom, 1, sizeof sim_eeprom, f) != sizeof sim_eeprom)
+            fprintf(stderr, "%s: short EEPROM image\n", eeprom_path);
+        fclose(f);
+    }
+
+    initialization();
+    plant_init(&cfg);
+    sim_ir = ir_at_start;
+    record_start();       // as main() does
+    calibration_init();
+    lap_map_init();
+    sim_ir = 0;
+    end_ns = (unsigned long long)(run_s * 1e9);
+    control_task = tasks[task_control].run;
+    tasks[task_control].run = timed_control;
+    wall = wall_seconds();
+
+    while (sim_time_ns < end_ns)
+    {
+        sim_ir = (obstacle_s >= 0.0 && sim_time_ns >= obstacle_s * 1e9
+                  && sim_time_ns < (obstacle_s + obstacle_for_s) * 1e9) ? obstacle_sides : 0u;
+        sched_run(tasks, TASKS);
+        if (sim_ir && reaction_s < 0.0 && obstacle_action != obstacle_none)
+            reaction_s = sim_time_ns * 1e-9 - obstacle_s;
+        if (line_found && line_frame_new)   // the reading the control pass steered by
+        {
+            c = (unsigned int)(line_position + LINE_POS_MAX + LINE_POS_PITCH / 2) / LINE_POS_PITCH;
+            age_ns = (double)(sim_time_ns - sim_frame_ns[c]);
+            age_sum_ns += age_ns;
+            if (age_ns > age_max_ns) age_max_ns = age_ns;
+            ages++;
+        }
+        if (SeeLine.B != last_seeline) seeline_changes++;
+        last_seeline = SeeLine.B;
+        if (trace)
+            fprintf(trace, "%.6f,%.2f,%.2f,%.4f,%u,%d,%u,%u,%u,%u,%u\n", sim_time_ns * 1e-9,
+                    plant.x_mm, plant.y_mm, plant.heading_rad, (unsigned int)SeeLine.B,
+                    line_position, line_found,
+                    sim_motor[left].duty, sim_motor[left].fwd, sim_motor[right].duty, sim_motor[right].fwd);
+    }
+    wall = wall_seconds() - wall;
+    if (trace) fclose(trace);
+    if (sim_uart) fclose(sim_uart);
+    if (eeprom_path)
+    {
+        if (!(f = fopen(eeprom_path, "wb")) || fwrite(sim_eeprom, 1, sizeof sim_eeprom, f) != sizeof sim_eeprom)
+            perror(eeprom_path);
+        if (f) fclose(f);
+    }
+
+    control_ns = tasks[task_control].runs ? control_wall * 1e9 / tasks[task_control].runs : 0.0;
+    if (bench)
+    {
+        // track, mode, laps, best lap s, mean lap s, off line events, off line s,
+        // ISR load /256, host ns per control pass
+        printf("%-12s %-6s %3u %7.3f %7.3f %4lu %7.3f %4u %6.0f\n",
+               cfg.track ? track.name : "circle", control_mode == pid_steering ? "pid" : "simple",
+               plant.lap_count, plant.lap_best_s,
+               plant.lap_count ? plant.lap_total_s / plant.lap_count : 0.0,
+               plant.offline_events, plant.offline_s, sched_load_avg >> 8, control_ns);
+        return 0;
+    }
+    printf("simulated     %.3f s in %.3f s wall (%.0fx real time)\n", sim_time_ns * 1e-9, wall,
+           wall > 0.0 ? sim_time_ns * 1e-9 / wall : 0.0);
+    printf("control loop  %u passes, %.0f Hz, %.0f ns host time per pass\n", tasks[task_control].runs,
+           tasks[task_control].runs / (sim_time_ns * 1e-9), control_ns);
+    printf("scheduler     load avg %u/256 max %u/256, %u slips, overruns", sched_load_avg >> 8,
+           sched_load_max, sched_slips);
+    for (i = 0; i < TASKS; i++) printf(" %u", tasks[i].overruns);
+    printf("\n");
+    printf("distance      %.0f mm, %.2f laps", plant.distance_mm, plant.laps);
+    if (plant.laps > 0.0) printf(", %.3f s per lap", sim_time_ns * 1e-9 / plant.laps);
+    printf("\n");
+    if (cfg.track && plant.lap_count)
+        printf("lap times     %u laps on %s, best %.3f s, mean %.3f s\n", plant.lap_count, track.name,
+               plant.lap_best_s, plant.lap_total_s / plant.lap_count);
+    printf("off the line  %.3f s, %lu times\n", plant.offline_s, plant.offline_events);
+    printf("battery       %.0f mV at the end, measured %u mV, duty scale %.3f%s\n", plant.battery_mv,
+           battery_mv, battery_scale / 256.0, battery_low ? ", low: top speed limited" : "");
+    printf("line features %u crossings, %u gaps driven straight through\n", crossings_seen, gaps_seen);
+    if (obstacle_s >= 0.0)
+    {
+        printf("obstacle      %u events", obstacle_events);
+        if (reaction_s >= 0.0) printf(", %s %.1f ms after it appeared", obstacle_sides == 3u ? "braked" : "slowed",
+                                      reaction_s * 1e3);
+        printf("\n");
+    }
+    if (ages) printf("sensor age    %.0f us mean, %.0f us max: the reading nearest the line, at the control pass\n",
+                     age_sum_ns / ages * 1e-3, age_max_ns * 1e-3);
+#ifdef INSTRUMENT
+    print_latency();
+#endif
+    printf("SeeLine       %lu changes, %.1f per s\n", seeline_changes, seeline_changes / (sim_time_ns * 1e-9));
+    if (lap_count > 1u) printf("last lap      %.3f s (%u stripes, map of %u segments)\n",
+                               lap_ticks * SCHED_TICK_US * 1e-6, lap_count, lap_segments);
+    if (lap_segments)
+    {
+        printf("lap map      ");
+        for (i = 0; i < lap_segments; i++) printf(" %c%u", "SLR"[lap_map[i].kind], lap_map[i].length);
+        printf("\n");
+    }
+    printf("thresholds   ");
+    for (i = 0; i < LINE_SENSORS; i++) printf(" %u", sensor_threshold[i]);
+    printf("\n");
+    return 0;
+}
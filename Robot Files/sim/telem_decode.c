@@ -0,0 +1,78 @@
+// telem_decode.c
+//   Converts the telemetry byte stream from the robot (telem_frame.h) to CSV.
+//
+//   usage: telem_decode [capture.bin | /dev/ttyUSB0 | /dev/pts/N]   (default stdin)
+//
+//   Reads a capture file, or a serial port / pty (set to raw 500000 baud),
+//   finds frames by their sync byte and CRC and writes one CSV line per frame
+//   to stdout. Anything between frames (printf text) is skipped. A summary
+//   of good frames, sequence gaps and skipped bytes goes to stderr.
+//   rev. Oct. 17, 2026 first version
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+#include "telem_frame.h"
+#include "sched.h"
+
+static void make_raw(int fd)
+{
+    struct termios tio;
+
+    if (!isatty(fd) || tcgetattr(fd, &tio) != 0) return;
+    cfmakeraw(&tio);
+    cfsetispeed(&tio, B500000);
+    cfsetospeed(&tio, B500000);
+    tcsetattr(fd, TCSANOW, &tio);
+}
+
+int main(int argc, char **argv)
+{
+    unsigned char buf[4096 + TELEM_FRAME_SIZE];
+    size_t have = 0, pos;
+    unsigned long frames = 0, lost = 0, skipped = 0;
+    unsigned int expect = 0;
+    struct telem_sample s;
+    ssize_t n;
+    int fd = 0;
+
+    if (argc > 2)
+    {
+        fprintf(stderr, "usage: %s [capture.bin | serial device]\n", argv[0]);
+        return 2;
+    }
+    if (argc == 2 && (fd = open(argv[1], O_RDONLY | O_NOCTTY)) < 0)
+    {
+        perror(argv[1]);
+        return 1;
+    }
+    make_raw(fd);
+
+    printf("seq,time_ms,adc_left,adc_cnt_left,adc_center,adc_cnt_right,adc_right,duty_left,duty_right\n");
+    while ((n = read(fd, buf + have, sizeof buf - have)) > 0)
+    {
+        have += (size_t)n;
+        pos = 0;
+        while (have - pos >= TELEM_FRAME_SIZE)
+        {
+            if (!telem_unpack(buf + pos, &s))
+            {
+                pos++;
+                skipped++;
+                continue;
+            }
+            if (frames != 0 && s.seq != (expect & 0xffu)) lost += (s.seq - expect) & 0xffu;
+            expect = s.seq + 1u;
+            frames++;
+            printf("%u,%.3f,%u,%u,%u,%u,%u,%d,%d\n", s.seq, s.time * (SCHED_TICK_US / 1000.0),
+                   s.adc[0], s.adc[1], s.adc[2], s.adc[3], s.adc[4], s.duty[0], s.duty[1]);
+            pos += TELEM_FRAME_SIZE;
+        }
+        memmove(buf, buf + pos, have - pos);
+        have -= pos;
+    }
+    fprintf(stderr, "%lu frames, %lu lost (sequence gaps), %lu bytes skipped\n", frames, lost, skipped + have);
+    return 0;
+}
@@ -0,0 +1,211 @@
+// track.c
+//   Loads raster tracks for plant.c, see track.h. PGM (P2 and P5) is read
+//   here; PNG goes through libpng when the simulator is built with it (the
+//   Makefile turns it on when pkg-config finds libpng).
+//   rev. Oct. 17, 2026 image sizes are checked and the allocation too
+//   rev. Oct. 17, 2026 first version
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+#ifdef SIM_PNG
+#include <png.h>
+#endif
+#include "track.h"
+
+// next number in a PGM header, skipping white space and # comments
+static int pgm_number(FILE *f, unsigned int *value)
+{
+    int c;
+
+    while ((c = fgetc(f)) != EOF)
+    {
+        if (c == '#') while ((c = fgetc(f)) != EOF && c != '\n') ;
+        else if (!isspace(c)) break;
+    }
+    if (c == EOF || !isdigit(c)) return -1;
+    *value = 0;
+    do
+    {
+        if (*value > 99999999u) return -1;   // no PGM field is that long, and it would overflow
+        *value = *value * 10u + (unsigned int)(c - '0');
+    }
+    while ((c = fgetc(f)) != EOF && isdigit(c));
+    return 0;
+}
+
+// allocates t->darkness for a width x height image, or prints why not
+static int alloc_image(struct track *t, const char *path)
+{
+    if (t->width == 0u || t->height == 0u || t->width > TRACK_MAX_SIDE || t->height > TRACK_MAX_SIDE)
+    {
+        fprintf(stderr, "%s: image of %u x %u pixels, 1 to %u a side\n", path, t->width, t->height,
+                TRACK_MAX_SIDE);
+        return -1;
+    }
+    if (!(t->darkness = malloc((size_t)t->width * t->height)))
+    {
+        fprintf(stderr, "%s: no memory for %u x %u pixels\n", path, t->width, t->height);
+        return -1;
+    }
+    return 0;
+}
+
+static int load_pgm(struct track *t, const char *path)
+{
+    FILE *f = fopen(path, "rb");
+    char magic[2];
+    unsigned int maxval, v, i, n;
+    int c;
+
+    if (!f)
+    {
+        perror(path);
+        return -1;
+    }
+    if (fread(magic, 1, 2, f) != 2 || magic[0] != 'P' || (magic[1] != '2' && magic[1] != '5')
+        || pgm_number(f, &t->width) || pgm_number(f, &t->height) || pgm_number(f, &maxval)
+        || maxval == 0u || maxval > 65535u)
+    {
+        fprintf(stderr, "%s: not a PGM image\n", path);
+        fclose(f);
+        return -1;
+    }
+    if (alloc_image(t, path))
+    {
+        fclose(f);
+        return -1;
+    }
+    n = t->width * t->height;
+    for (i = 0; i < n; i++)
+    {
+        if (magic[1] == '2')
+        {
+            if (pgm_number(f, &v)) break;
+        }
+        else
+        {
+            if ((c = fgetc(f)) == EOF) break;
+            v = (unsigned int)c;
+            if (maxval > 255u)
+            {
+                if ((c = fgetc(f)) == EOF) break;
+                v = (v << 8) | (unsigned int)c;
+            }
+        }
+        t->darkness[i] = (unsigned char)(255u - v * 255u / maxval);
+    }
+    fclose(f);
+    if (i != n)
+    {
+        fprintf(stderr, "%s: image data ends early\n", path);
+        free(t->darkness);
+        t->darkness = NULL;
+        return -1;
+    }
+    return 0;
+}
+
+static int load_png(struct track *t, const char *path)
+{
+#ifdef SIM_PNG
+    png_image image;
+    unsigned int i;
+
+    memset(&image, 0, sizeof image);
+    image.version = PNG_IMAGE_VERSION;
+    if (!png_image_begin_read_from_file(&image, path))
+    {
+        fprintf(stderr, "%s: %s\n", path, image.message);
+        return -1;
+    }
+    image.format = PNG_FORMAT_GRAY;
+    t->width = image.width;
+    t->height = image.height;
+    if (alloc_image(t, path))   // PNG_IMAGE_SIZE() is width * height for PNG_FORMAT_GRAY
+    {
+        png_image_free(&image);
+        return -1;
+    }
+    if (!png_image_finish_read(&image, NULL, t->darkness, 0, NULL))
+    {
+        fprintf(stderr, "%s: %s\n", path, image.message);
+        free(t->darkness);
+        t->darkness = NULL;
+        return -1;
+    }
+    for (i = 0; i < t->width * t->height; i++) t->darkness[i] = (unsigned char)(255u - t->darkness[i]);
+    return 0;
+#else
+    fprintf(stderr, "%s: this simulator was built without libpng, use a PGM image\n", path);
+    return -1;
+#endif
+}
+
+int track_load(struct track *t, const char *path)
+{
+    FILE *f = fopen(path, "r");
+    char line[256], key[32], value[200], image[512];
+    const char *slash, *base;
+    double heading_deg = 0.0;
+    size_t len;
+
+    memset(t, 0, sizeof *t);
+    image[0] = '\0';
+    if (!f)
+    {
+        perror(path);
+        return -1;
+    }
+    while (fgets(line, sizeof line, f))
+    {
+        if (line[0] == '#' || sscanf(line, "%31s %199[^\n]", key, value) != 2) continue;
+        if (!strcmp(key, "image"))
+        {
+            sscanf(value, "%199s", value);
+            slash = strrchr(path, '/');
+            len = slash && value[0] != '/' ? (size_t)(slash - path + 1) : 0;   // relative to the .track file
+            snprintf(image, sizeof image, "%.*s%s", (int)len, path, value);
+        }
+        else if (!strcmp(key, "mm_per_px")) t->mm_per_px = atof(value);
+        else if (!strcmp(key, "start"))
+            sscanf(value, "%lf %lf %lf", &t->start_x_mm, &t->start_y_mm, &heading_deg);
+    }
+    fclose(f);
+    if (image[0] == '\0' || t->mm_per_px <= 0.0)
+    {
+        fprintf(stderr, "%s: needs an image and mm_per_px\n", path);
+        return -1;
+    }
+    t->start_heading_rad = heading_deg * M_PI / 180.0;
+    base = strrchr(path, '/') ? strrchr(path, '/') + 1 : path;
+    snprintf(t->name, sizeof t->name, "%.*s", (int)strcspn(base, "."), base);
+
+    len = strlen(image);
+    if (len > 4 && !strcmp(image + len - 4, ".png")) return load_png(t, image);
+    return load_pgm(t, image);
+}
+
+double track_darkness(const struct track *t, double x_mm, double y_mm, double radius_mm)
+{
+    double cx = x_mm / t->mm_per_px, cy = (t->height - 1) - y_mm / t->mm_per_px;
+    double r = radius_mm / t->mm_per_px, dx, dy;
+    int i, j;
+    unsigned long sum = 0, count = 0;
+
+    for (j = (int)floor(cy - r); j <= (int)ceil(cy + r); j++)
+    {
+        for (i = (int)floor(cx - r); i <= (int)ceil(cx + r); i++)
+        {
+            dx = i - cx;
+            dy = j - cy;
+            if (dx * dx + dy * dy > r * r) continue;
+            count++;
+            if (i >= 0 && j >= 0 && (unsigned int)i < t->width && (unsigned int)j < t->height)
+                sum += t->darkness[(unsigned int)j * t->width + (unsigned int)i];
+        }
+    }
+    return count ? sum / (255.0 * count) : 0.0;
+}
@@ -0,0 +1,38 @@
+// track.h
+//   Raster tracks for the simulator. A track is a grey scale image seen
+//   from above (dark line on a light floor) plus a small text file that
+//   gives its scale and the start pose:
+//
+//     # comment
+//     image      oval.png       (PNG or PGM, relative to the .track file)
+//     mm_per_px  2
+//     start      1200 150 0     (x mm, y mm from the bottom left corner, heading deg,
+//                                0 along +x, counter clockwise positive)
+//
+//   The robot starts at the start pose and a lap is counted each time its
+//   axle crosses the start line (through the start pose, square to the
+//   start heading) going forward.
+//   rev. Oct. 17, 2026 images over TRACK_MAX_SIDE pixels a side are refused
+//   rev. Oct. 17, 2026 first version
+
+#ifndef TRACK_H
+#define TRACK_H
+
+#define TRACK_MAX_SIDE  16384u   // pixels, 32 m at 2 mm_per_px; a larger header is corrupt
+
+struct track
+{
+    unsigned int width, height;      // pixels
+    unsigned char *darkness;         // 0 floor ... 255 black line, row 0 at the top
+    double mm_per_px;
+    double start_x_mm, start_y_mm, start_heading_rad;
+    char name[64];
+};
+
+int track_load(struct track *t, const char *path);
+                 // reads a .track file and its image, prints the reason and
+                 // returns -1 on failure
+double track_darkness(const struct track *t, double x_mm, double y_mm, double radius_mm);
+                 // mean darkness (0 to 1) of the disc at (x, y), outside the image is floor
+
+#endif // TRACK_H
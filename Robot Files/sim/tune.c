@@ -0,0 +1,471 @@
+// tune.c
+//   Auto tuner: searches threshold, the motor_speeds[] table and the PID
+//   gains for the shortest lap times on a set of raster tracks (track.h)
+//   by running the unchanged control loop in the simulator, and writes the
+//   best constants as tuned.h for the firmware (build with TUNED defined,
+//   see sumovore.h).
+//
+//   usage: sumovore_tune -T file.track [-T file.track ...] [-m simple|pid] [-L]
+//                        [-t seconds] [-v v_max_mm_s] [-n noise] [-s seed] [-j jobs]
+//                        [-p name[=lo:hi]] ... [-g points] [-G generations] [-l lambda]
+//                        [-o tuned.h]
+//     -p  search this parameter (over its default range or lo ... hi), the
+//         others keep their defaults; without -p the parameters the control
+//         mode uses are searched
+//     -g  grid search with this many points across each searched parameter,
+//         otherwise a separable CMA-ES (diagonal covariance) runs for -G
+//         generations of -l candidates
+//     -j  simulated runs at a time, one per core by default
+//
+//   Every run is one candidate on one track. The firmware keeps its state
+//   in globals, so runs cannot share a process: each is forked from the
+//   untouched tuner, writes its result to shared memory and exits. The
+//   pool keeps -j of them going and gives the next run to whichever slot
+//   comes free first, so a slow run never holds up the others.
+//
+//   A candidate scores the sum over the tracks of its mean lap time plus
+//   OFFLINE_PENALTY times its time off the line per lap; a run that does
+//   not finish a lap scores NO_LAP_S.
+//   rev. Oct. 17, 2026 grid size limit (GRID_MAX)
+//   rev. Oct. 17, 2026 first version
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+#include "sumovore.h"
+#include "motor_control.h"
+#include "pid_steer.h"
+#include "sched.h"
+#include "tasks.h"
+#include "calibration.h"
+#include "lap_map.h"
+#include "sim.h"
+#include "track.h"
+
+#define MAX_TRACKS       8
+#define OFFLINE_PENALTY  2.0     // seconds of lap time per second off the line
+#define NO_LAP_S         1000.0
+#define GRID_MAX         100000u // grid candidates, days of runs already
+
+enum { p_threshold, p_rev_fast, p_rev_medium, p_rev_slow, p_slow, p_medium, p_fast,
+       p_kp, p_ki, p_kd, PARAMS };
+
+struct param
+{
+    const char *name;
+    int value;               // the firmware default
+    int lo, hi;              // search range
+    unsigned char search;
+};
+
+static struct param param[PARAMS] =
+{
+    { "threshold",  THRESHOLD_DEFAULT, 200, 800, 0 },
+    { "rev_fast",   -800, -800, -400, 0 },
+    { "rev_medium", -725, -800, -300, 0 },
+    { "rev_slow",   -650, -800, -200, 0 },
+    { "slow",        650,  200,  800, 0 },
+    { "medium",      725,  300,  800, 0 },
+    { "fast",        800,  400,  800, 0 },
+    { "kp",          PID_KP_DEFAULT, 0, 1200, 0 },
+    { "ki",          PID_KI_DEFAULT, 0, 16, 0 },
+    { "kd",          PID_KD_DEFAULT, 0, 4000, 0 },
+};
+
+struct result
+{
+    unsigned int laps;
+    double lap_mean_s;
+    double offline_s;
+};
+
+static struct track track[MAX_TRACKS];
+static unsigned int tracks;
+static struct plant_config cfg =
+{
+    .track_radius_mm = 400.0, .straight_mm = 0.0, .v_max_mm_s = 600.0, .deadband = 96.0,
+    .seed = 1u, .noise = 12.0, .sensor_spread = 0.0, .track = NULL,
+    .battery_mv = 0.0, .battery_drain_mv_s = 0.0   // SIM_BATTERY_MV, no drain
+};
+static double run_s = 40.0;
+static unsigned int jobs_max;
+static struct result *results;    // shared with the children
+
+// one simulated run, in a child process
+static void run(const int *value, unsigned int t, struct result *r)
+{
+    unsigned long long end_ns = (unsigned long long)(run_s * 1e9);
+    int i;
+
+    memset(sim_eeprom, 0xff, sizeof sim_eeprom);
+    initialization();
+    threshold = (unsigned int)value[p_threshold];
+    for (i = 0; i < 7; i++) if (i != stop) motor_speeds[i] = value[p_rev_fast + (i < stop ? i : i - 1)];
+    pid.kp = value[p_kp];
+    pid.ki = value[p_ki];
+    pid.kd = value[p_kd];
+    cfg.track = &track[t];
+    plant_init(&cfg);
+    calibration_init();
+    lap_map_init();
+    while (sim_time_ns < end_ns) sched_run(tasks, TASKS);
+    r->laps = plant.lap_count;
+    r->lap_mean_s = plant.lap_count ? plant.lap_total_s / plant.lap_count : 0.0;
+    r->offline_s = plant.offline_s;
+}
+
+// runs every candidate on every track, jobs_max runs at a time, and
+// returns each candidate's score in score[]
+static void evaluate(int (*value)[PARAMS], unsigned int candidates, double *score)
+{
+    unsigned int runs = candidates * tracks, next = 0, busy = 0, c, t;
+    int status;
+    pid_t child;
+
+    memset(results, 0, runs * sizeof *results);
+    fflush(stdout);
+    while (next < runs || busy)
+    {
+        if (next < runs && busy < jobs_max)
+        {
+            child = fork();
+            if (child == 0)
+            {
+                run(value[next / tracks], next % tracks, &results[next]);
+                _exit(0);
+            }
+            if (child < 0)
+            {
+                perror("fork");
+                exit(1);
+            }
+            next++;
+            busy++;
+            continue;
+        }
+        if (wait(&status) > 0) busy--;
+    }
+    for (c = 0; c < candidates; c++)
+    {
+        score[c] = 0.0;
+        for (t = 0; t < tracks; t++)
+        {
+            struct result *r = &results[c * tracks + t];
+
+            score[c] += r->laps ? r->lap_mean_s + OFFLINE_PENALTY * r->offline_s / r->laps : NO_LAP_S;
+        }
+    }
+}
+
+// xorshift and Box-Muller, so a search repeats with the same -s
+static unsigned long rng_state = 88172645ul;
+
+static double uniform(void)
+{
+    rng_state ^= (rng_state << 13) & 0xfffffffful;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= (rng_state << 5) & 0xfffffffful;
+    return ((rng_state & 0xfffffffful) + 0.5) / 4294967296.0;
+}
+
+static double gaussian(void)
+{
+    return sqrt(-2.0 * log(uniform())) * cos(2.0 * M_PI * uniform());
+}
+
+// a point of the unit cube in the searched parameters to their values
+static void to_values(const double *y, int *value)
+{
+    int i, k = 0;
+    double u;
+
+    for (i = 0; i < PARAMS; i++)
+    {
+        value[i] = param[i].value;
+        if (!param[i].search) continue;
+        u = y[k++];
+        if (u < 0.0) u = 0.0;
+        if (u > 1.0) u = 1.0;
+        value[i] = param[i].lo + (int)floor(u * (param[i].hi - param[i].lo) + 0.5);
+    }
+}
+
+static int best_value[PARAMS];
+static double best_score = 1e30;
+static unsigned long runs_done;
+
+static void keep_best(int (*value)[PARAMS], const double *score, unsigned int candidates)
+{
+    unsigned int c;
+
+    runs_done += candidates * tracks;
+    for (c = 0; c < candidates; c++)
+        if (score[c] < best_score)
+        {
+            best_score = score[c];
+            memcpy(best_value, value[c], sizeof best_value);
+        }
+}
+
+static void grid_search(unsigned int n, unsigned int points)
+{
+    unsigned int candidates = 1, c, k, i;
+    int (*value)[PARAMS];
+    double *score, y[PARAMS];
+
+    for (k = 0; k < n; k++)
+    {
+        if (candidates > GRID_MAX / points)
+        {
+            fprintf(stderr, "grid of %u^%u candidates is too big, at most %u\n", points, n, GRID_MAX);
+            exit(1);
+        }
+        candidates *= points;
+    }
+    value = malloc(candidates * sizeof *value);
+    score = malloc(candidates * sizeof *score);
+    results = mmap(NULL, candidates * tracks * sizeof *results, PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (!value || !score || results == MAP_FAILED)
+    {
+        fprintf(stderr, "grid of %u candidates is too big\n", candidates);
+        exit(1);
+    }
+    for (c = 0; c < candidates; c++)
+    {
+        for (k = 0, i = c; k < n; k++, i /= points)
+            y[k] = points > 1 ? (double)(i % points) / (points - 1) : 0.5;
+        to_values(y, value[c]);
+    }
+    evaluate(value, candidates, score);
+    keep_best(value, score, candidates);
+}
+
+// separable CMA-ES (Ros and Hansen 2008): a diagonal covariance, step size
+// by cumulative path length, in the unit cube of the searched parameters,
+// starting from the firmware defaults
+static void cma_es(unsigned int n, unsigned int lambda, unsigned int generations)
+{
+    unsigned int mu = lambda / 2, g, c, k, i, order[256];
+    double m[PARAMS], m_old[PARAMS], d[PARAMS], cov[PARAMS], ps[PARAMS], pc[PARAMS];
+    double z[256][PARAMS], y[256][PARAMS], w[256], score[256];
+    double mueff, cs, ds, cc, c1, cmu, chi_n, sigma = 0.2, norm, sum, h;
+    int (*value)[PARAMS] = malloc(lambda * sizeof *value);
+
+    results = mmap(NULL, lambda * tracks * sizeof *results, PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (!value || results == MAP_FAILED)
+    {
+        perror("sumovore_tune");
+        exit(1);
+    }
+    for (i = 0, sum = 0.0; i < mu; i++) sum += w[i] = log(mu + 0.5) - log(i + 1.0);
+    for (i = 0, norm = 0.0; i < mu; i++)
+    {
+        w[i] /= sum;
+        norm += w[i] * w[i];
+    }
+    mueff = 1.0 / norm;
+    cs = (mueff + 2.0) / (n + mueff + 5.0);
+    ds = 1.0 + 2.0 * fmax(0.0, sqrt((mueff - 1.0) / (n + 1.0)) - 1.0) + cs;
+    cc = (4.0 + mueff / n) / (n + 4.0 + 2.0 * mueff / n);
+    c1 = 2.0 / ((n + 1.3) * (n + 1.3) + mueff) * (n + 2.0) / 3.0;
+    cmu = fmin(1.0 - c1, 2.0 * (mueff - 2.0 + 1.0 / mueff) / ((n + 2.0) * (n + 2.0) + mueff) * (n + 2.0) / 3.0);
+    chi_n = sqrt(n) * (1.0 - 1.0 / (4.0 * n) + 1.0 / (21.0 * n * n));
+    for (i = 0, k = 0; i < PARAMS; i++)
+        if (param[i].search)
+        {
+            m[k] = (double)(param[i].value - param[i].lo) / (param[i].hi - param[i].lo);
+            cov[k] = 1.0;
+            ps[k] = pc[k] = 0.0;
+            k++;
+        }
+
+    for (g = 0; g < generations; g++)
+    {
+        for (k = 0; k < n; k++) d[k] = sqrt(cov[k]);
+        for (c = 0; c < lambda; c++)
+        {
+            for (k = 0; k < n; k++)
+            {
+                z[c][k] = gaussian();
+                y[c][k] = m[k] + sigma * d[k] * z[c][k];
+            }
+            to_values(y[c], value[c]);
+            order[c] = c;
+        }
+        evaluate(value, lambda, score);
+        keep_best(value, score, lambda);
+        for (c = 1; c < lambda; c++)          // rank the candidates, best first
+            for (i = c; i > 0 && score[order[i]] < score[order[i - 1]]; i--)
+            {
+                k = order[i];
+                order[i] = order[i - 1];
+                order[i - 1] = k;
+            }
+        printf("generation %3u  best %8.3f  this %8.3f  step %.3f\n", g + 1, best_score,
+               score[order[0]], sigma);
+
+        for (k = 0; k < n; k++)
+        {
+            m_old[k] = m[k];
+            for (i = 0, m[k] = 0.0; i < mu; i++) m[k] += w[i] * y[order[i]][k];
+        }
+        for (k = 0, norm = 0.0; k < n; k++)
+        {
+            ps[k] = (1.0 - cs) * ps[k] + sqrt(cs * (2.0 - cs) * mueff) * (m[k] - m_old[k]) / (sigma * d[k]);
+            norm += ps[k] * ps[k];
+        }
+        h = sqrt(norm) / sqrt(1.0 - pow(1.0 - cs, 2.0 * (g + 1))) < (1.4 + 2.0 / (n + 1.0)) * chi_n;
+        for (k = 0; k < n; k++)
+        {
+            pc[k] = (1.0 - cc) * pc[k] + h * sqrt(cc * (2.0 - cc) * mueff) * (m[k] - m_old[k]) / sigma;
+            for (i = 0, sum = 0.0; i < mu; i++)
+                sum += w[i] * (y[order[i]][k] - m_old[k]) * (y[order[i]][k] - m_old[k]) / (sigma * sigma);
+            cov[k] = (1.0 - c1 - cmu) * cov[k] + c1 * pc[k] * pc[k] + cmu * sum;
+        }
+        sigma *= exp(cs / ds * (sqrt(norm) / chi_n - 1.0));
+        if (sigma > 0.5) sigma = 0.5;
+    }
+}
+
+static int write_header(const char *path, const char *how, double default_score)
+{
+    FILE *f = fopen(path, "w");
+    int *v = best_value;
+    unsigned int t;
+
+    if (!f)
+    {
+        perror(path);
+        return -1;
+    }
+    fprintf(f, "// tuned.h\n");
+    fprintf(f, "//   Written by sumovore_tune (sim/tune.c), do not edit: %s, %lu runs,\n", how, runs_done);
+    fprintf(f, "//   %s control, %.0f s per run, tracks", control_mode == pid_steering ? "pid" : "simple", run_s);
+    for (t = 0; t < tracks; t++) fprintf(f, " %s", track[t].name);
+    fprintf(f, "\n//   score %.3f (the defaults score %.3f)\n\n", best_score, default_score);
+    fprintf(f, "#ifndef TUNED_H\n#define TUNED_H\n\n");
+    fprintf(f, "#define THRESHOLD_DEFAULT    %uu\n", (unsigned int)v[p_threshold]);
+    fprintf(f, "#define MOTOR_SPEEDS_DEFAULT { %d, %d, %d, 0, %d, %d, %d }\n", v[p_rev_fast],
+            v[p_rev_medium], v[p_rev_slow], v[p_slow], v[p_medium], v[p_fast]);
+    fprintf(f, "#define PID_KP_DEFAULT       %d\n", v[p_kp]);
+    fprintf(f, "#define PID_KI_DEFAULT       %d\n", v[p_ki]);
+    fprintf(f, "#define PID_KD_DEFAULT       %d\n", v[p_kd]);
+    fprintf(f, "\n#endif // TUNED_H\n");
+    return fclose(f);
+}
+
+static int select_param(char *arg)
+{
+    char *range = strchr(arg, '=');
+    int i;
+
+    if (range) *range++ = '\0';
+    for (i = 0; i < PARAMS; i++)
+        if (!strcmp(arg, param[i].name))
+        {
+            param[i].search = 1;
+            if (range && sscanf(range, "%d:%d", &param[i].lo, &param[i].hi) != 2) return -1;
+            return param[i].lo < param[i].hi ? 0 : -1;
+        }
+    return -1;
+}
+
+int main(int argc, char **argv)
+{
+    const char *out_path = "tuned.h";
+    unsigned int points = 0, generations = 30, lambda = 16, n = 0, i;
+    int opt, any = 0, defaults[1][PARAMS];
+    double default_score, wall;
+    struct timespec ts;
+    char how[64];
+
+    jobs_max = (unsigned int)sysconf(_SC_NPROCESSORS_ONLN);
+    while ((opt = getopt(argc, argv, "T:m:Lt:v:n:s:j:p:g:G:l:o:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'T':
+            if (tracks == MAX_TRACKS || track_load(&track[tracks], optarg)) return 1;
+            tracks++;
+            break;
+        case 'm': control_mode = strcmp(optarg, "pid") ? simple_curves : pid_steering; break;
+        case 'L': lap_learning = 1; break;
+        case 't': run_s = atof(optarg); break;
+        case 'v': cfg.v_max_mm_s = atof(optarg); break;
+        case 'n': cfg.noise = atof(optarg); break;
+        case 's': cfg.seed = (unsigned int)strtoul(optarg, NULL, 0); rng_state += cfg.seed; break;
+        case 'j': jobs_max = (unsigned int)atoi(optarg); break;
+        case 'p':
+            if (select_param(optarg))
+            {
+                fprintf(stderr, "-p %s: unknown parameter or empty range\n", optarg);
+                return 2;
+            }
+            any = 1;
+            break;
+        case 'g': points = (unsigned int)atoi(optarg); break;
+        case 'G': generations = (unsigned int)atoi(optarg); break;
+        case 'l': lambda = (unsigned int)atoi(optarg); break;
+        case 'o': out_path = optarg; break;
+        default:
+            goto usage;
+        }
+    }
+    if (!tracks || jobs_max < 1u || lambda < 4u || lambda > 256u) goto usage;
+    if (!any)    // what the control mode uses
+    {
+        param[p_threshold].search = 1;
+        param[p_fast].search = 1;
+        if (control_mode == pid_steering || lap_learning) param[p_medium].search = 1;
+        if (control_mode == pid_steering)
+        {
+            param[p_kp].search = 1;
+            param[p_ki].search = 1;
+            param[p_kd].search = 1;
+        }
+        else for (i = p_rev_fast; i <= p_medium; i++) param[i].search = 1;
+    }
+    for (i = 0; i < PARAMS; i++) n += param[i].search;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    wall = ts.tv_sec + ts.tv_nsec * 1e-9;
+    for (i = 0; i < PARAMS; i++) defaults[0][i] = param[i].value;
+    results = mmap(NULL, tracks * sizeof *results, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (results == MAP_FAILED)
+    {
+        perror("mmap");
+        return 1;
+    }
+    evaluate(defaults, 1, &default_score);
+    keep_best(defaults, &default_score, 1);
+    munmap(results, tracks * sizeof *results);
+    printf("defaults score %.3f, searching %u parameters with %u jobs at a time\n", default_score, n, jobs_max);
+
+    if (points)
+    {
+        grid_search(n, points);
+        snprintf(how, sizeof how, "grid of %u points per parameter", points);
+    }
+    else
+    {
+        cma_es(n, lambda, generations);
+        snprintf(how, sizeof how, "CMA-ES %u x %u", generations, lambda);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    printf("%lu runs in %.1f s, best score %.3f:", runs_done, ts.tv_sec + ts.tv_nsec * 1e-9 - wall, best_score);
+    for (i = 0; i < PARAMS; i++) if (param[i].search) printf(" %s %d", param[i].name, best_value[i]);
+    printf("\n");
+    return write_header(out_path, how, default_score) ? 1 : 0;
+
+usage:
+    fprintf(stderr, "usage: %s -T file.track [-T file.track ...] [-m simple|pid] [-L] [-t seconds] [-v v_max_mm_s] [-n noise] [-s seed] [-j jobs] [-p name[=lo:hi]] ... [-g points] [-G generations] [-l lambda] [-o tuned.h]\n", argv[0]);
+    return 2;
+}
@@ -16,6 +16,9 @@
 
 // *******************************************************************
 
+#ifndef SUMOVORE_H    // rev. Oct. 17, 2026 include guard so hal.h and later
+#define SUMOVORE_H    //   headers can pull in the types declared here
+
 // rev. April 3, 2014 end of macro changed to =!a from =~a to avoid warning from new XC8 compiler
 #define setLED1(a) PORTDbits.RD0=!a  // When a = ON or OFF, 
 #define setLED2(a) PORTDbits.RD1=!a  //  setLEDn(ON) turns on LEDn
@@ -38,9 +41,11 @@
 #define    EnableRmotor  PORTCbits.RC2    // pin_c2  -- Enable Right motor  
 #define    EnableLmotor  PORTCbits.RC1    // pin_c1  -- Enable Left motor   
 #define    RmotorGoFwd   PORTCbits.RC5    // rev for bb2  -- Right motor forward 
-#define    RmotorGoFwdCmp PORTEbits.RE0   // rev for bb2  -- Right motor forward complement
+#define    RmotorGoFwdCmp LATEbits.LATE0  // rev for bb2  -- Right motor forward complement
 #define    LmotorGoFwd   PORTCbits.RC0    // rev for bb2  -- Left motor forward  
-#define    LmotorGoFwdCmp PORTEbits.RE1   // rev for bb2  -- Left motor forward complement
+#define    LmotorGoFwdCmp LATEbits.LATE1  // rev for bb2  -- Left motor forward complement
+                    // rev. Oct. 17, 2026 LATE: RE0 and RE1 are analog (AN0_AN7) and read as 0,
+                    //   a read-modify-write of PORTE would clear the other line
 
 #define    RLS_LeftCH0      ADC_CH0    // AN0  (left reflective line sensor)
 #define    RLS_CntLeftCH1   ADC_CH1    // AN1  (center left reflective line sensor)
@@ -59,8 +64,27 @@
                            // A/D port Configuration Control Bits
                            // these determine which pins are analog inputs
                            // see page 224 of PIC18F4525 datasheet
-
+#define AN0_AN7    0B0111  // rev. Oct. 17, 2026 AN0-AN4 and the battery on AN7 (battery.h),
+                           //   AN5 and AN6 (RE0, RE1) come with it
+
+#ifdef TUNED                // rev. Oct. 17, 2026 define TUNED on the compiler command line
+#ifdef __has_include
+#if !__has_include("tuned.h")
+#error "TUNED needs tuned.h: run sim/build/sumovore_tune -T file.track [-m simple|pid] [-L] -o tuned.h first"
+#endif
+#endif
+#include "tuned.h"          //   to build with the constants found by the simulator's
+#endif                      //   auto tuner (sim/tune.c) instead of the ones below
+
+#ifndef THRESHOLD_DEFAULT
 #define THRESHOLD_DEFAULT 512u
+#endif
+#ifndef MOTOR_SPEEDS_DEFAULT // duty of each motor_speed_setting, rev_fast ... fast
+#define MOTOR_SPEEDS_DEFAULT { -800, -725, -650, 0, 650, 725, 800 }
+#endif
+
+#define LINE_SENSORS 5     // index 0 is the left sensor (AN0) ... 4 the right (AN4)
+                           // rev. Oct. 17, 2026
 
 extern unsigned int threshold;    // this declaration makes it possible to change threshold in 
                                 // other files that include sumovore.h (like main.c)
@@ -71,6 +95,8 @@ extern unsigned int threshold;    // this declaration makes it possible to chang
                                // This has been added so that students can change the contents of 
                                // threshold without making changes to either sumovore.c or sumovore.h
                                // which should be discouraged
+                               // rev. Oct. 17, 2026 only used for sensors without a stored
+                               //   calibration, see calibration.h
 
 struct sensors
 {
@@ -92,7 +118,7 @@ union sensor_union         // revised May 14, 2011
     struct sensors b;
 };
 
-void initialization(void);  // defined in sumovore.c
+void initialization(void);  // defined in hal_pic18.c (sim/hal_sim.c for the simulator)
 
 unsigned int adc(unsigned char channel);  // defined in sumovore.c
 
@@ -102,10 +128,46 @@ enum motor_selection { left, right };
 
 void set_motor_speed(enum motor_selection the_motor, enum motor_speed_setting motor_speed, int speed_modifier);
                  // defined in sumovore.c
-void motors_brake_all( void );
+                 // rev. Oct. 17, 2026 a wrapper for set_motor_duty()
+void set_motor_duty(enum motor_selection the_motor, int duty);
+                 // duty -800 (full reverse) ... 800 (full forward), the motor gets
+                 // there at MOTOR_SLEW per tick through motor_output_update()
+                 // rev. Oct. 17, 2026 duty is for a pack at BATTERY_NOMINAL_MV, it is
+                 // scaled for the measured battery voltage first (battery.h)
+void motor_output_update(void);
+                 // once per control tick: slews each motor toward its duty and drives
+                 // the PWM, with MOTOR_DEADBAND added to any duty that is not 0
+void motors_brake_all( void );  // brakes at once, until the next set_motor_duty()
 void set_leds(void);
 void check_sensors(void);
-void LVtrap(void);
+void LVtrap(void);          // defined in hal_pic18.c
 
 extern union sensor_union SeeLine;  // defn. is in sumovore.c
-
+extern unsigned int line_adc[LINE_SENSORS];    // raw 10 bit readings behind SeeLine, [0] Left ... [4] Right
+                                    // updated by check_sensors(), defn. is in sumovore.c
+extern unsigned char line_frame_new; // 1 when the last check_sensors() got a new frame
+extern unsigned int line_norm[LINE_SENSORS];   // line_adc[] scaled to 0 (floor) ... 1023 (line) with
+                                    // each sensor's calibration, see calibration.h
+
+#define MOTOR_SLEW      80          // duty change per control tick away from 0 (speeding
+                                    //   up), 0 to full in 10 ms    rev. Oct. 17, 2026
+                                    //   pid_steering runs as well with 20, simple_curves
+                                    //   loses time with less than 80 (it steers by spinning)
+#define MOTOR_SLEW_DOWN 800         //   and toward 0 (slowing down), at once
+#define MOTOR_BRAKE_HOLD 8          // ticks of brake after which the slew limited duty
+                                    //   counts as stopped, so the next drive ramps up from 0
+#define MOTOR_DEADBAND  96          // PWM duty below which the motors do not turn,
+                                    //   duty 1 ... 800 is spread over MOTOR_DEADBAND ... 800
+
+extern int motor_speeds[7];         // duty of each motor_speed_setting, can be changed from
+                                    //   main.c like threshold    rev. Oct. 17, 2026
+
+#define DUTY_BRAKE  (-2048)         // motor_duty[] value while motors_brake_all() is in effect
+extern int motor_duty[2];           // last duty cycle given to each motor (enum motor_selection),
+                                    // -800 full reverse ... 800 full forward, or DUTY_BRAKE
+                                    // defn. is in sumovore.c
+extern int motor_command[2];        // rev. Oct. 17, 2026 duty last asked of set_motor_duty()
+                                    // for each motor, limited to -800 ... 800 but before the
+                                    // battery scaling and the slew limit, or DUTY_BRAKE
+
+#endif // SUMOVORE_H
@@ -0,0 +1,80 @@
+// tasks.c
+//   Tasks run by the fixed rate scheduler, see sched.h
+//   rev. Oct. 17, 2026 latency histogram task and end point (instrument.h)
+//   rev. Oct. 17, 2026 IR obstacle task (obstacle.h)
+//   rev. Oct. 17, 2026 warm restart snapshots (persist.h)
+//   rev. Oct. 17, 2026 battery voltage task (battery.h)
+//   rev. Oct. 17, 2026 flight recorder (record.h)
+//   rev. Oct. 17, 2026 first version
+
+#include <stdio.h>
+#include "sumovore.h"
+#include "motor_control.h"
+#include "sched.h"
+#include "tasks.h"
+#include "instrument.h"
+#include "telemetry.h"
+#include "calibration.h"
+#include "eeprom.h"
+#include "record.h"
+#include "battery.h"
+#include "persist.h"
+#include "obstacle.h"
+
+void sense_and_control(void);
+void report_status(void);
+void no_report(void);
+
+struct sched_task tasks[TASKS] =
+{
+    //  run                period                countdown (offset)
+    { sense_and_control,  CONTROL_PERIOD_TICKS, 0u },
+    { set_leds,           LED_PERIOD_TICKS,     1u },  // from sumovore.c
+    { no_report,          REPORT_PERIOD_TICKS,  2u },
+ // { report_status,      REPORT_PERIOD_TICKS,  2u },  // use this line instead to print
+                                                       //   scheduler statistics
+    { eeprom_task,        EEPROM_PERIOD_TICKS,  3u },  // background EEPROM writes, see eeprom.h
+    { battery_task,       BATTERY_PERIOD_TICKS, 5u },  // duty compensation, see battery.h
+    { obstacle_task,      OBSTACLE_PERIOD_TICKS, 2u },  // IR detectors, see obstacle.h
+#ifdef INSTRUMENT
+    { instrument_report,  REPORT_PERIOD_TICKS,  500u },  // cycle counts, see instrument.h
+    { latency_report,     REPORT_PERIOD_TICKS,  250u },  // sensor to motor latency, well
+                                                         //   clear of the cycle count lines
+#endif
+#ifdef RECORD
+    { record_task,        RECORD_PERIOD_TICKS,  0u },    // flight recorder output, see record.h
+#endif
+#ifdef SUPERVISOR
+    { persist_task,       PERSIST_PERIOD_TICKS, 7u },    // warm restart state, see persist.h
+#endif
+};
+
+void sense_and_control(void)
+{
+    PROBE_BEGIN(probe_check_sensors);
+    check_sensors();    // from sumovore.c
+    PROBE_END(probe_check_sensors);
+    PROBE_BEGIN(probe_motor_control);
+    if (calibrating) calibration_step();   // the calibration sweep has the motors
+    else motor_control();                  // from motor_control.c
+    motor_output_update();                 // slew limited duty to the PWM, sumovore.c
+    PROBE_END(probe_motor_control);
+    LATENCY_END();      // from the frame's first conversion to here, INSTRUMENT only
+    telemetry_send();   // one frame per pass when TELEMETRY is defined
+    record_pass();      // and one flight recorder record when RECORD is defined
+}
+
+// prints the CPU load and overrun counts. printf() only queues the text
+// (uart_tx.c), the USART sends it in the background.
+void report_status(void)
+{
+    unsigned char i;
+
+    printf("load %u/256 max %u/256 slips %u overruns", sched_load_avg >> 8, sched_load_max, sched_slips);
+    for (i = 0; i < TASKS; i++) printf(" %u", tasks[i].overruns);
+    printf("\n\r");
+}
+
+void no_report(void)
+{
+}
@@ -0,0 +1,40 @@
+// tasks.h
+//   The task table main() hands to sched_run() (the simulator uses the same
+//   table). Periods are in scheduler ticks of SCHED_TICK_US.
+//   rev. Oct. 17, 2026 latency histogram task (INSTRUMENT)
+//   rev. Oct. 17, 2026 obstacle task
+//   rev. Oct. 17, 2026 warm restart snapshots (SUPERVISOR)
+//   rev. Oct. 17, 2026 battery task
+//   rev. Oct. 17, 2026 flight recorder task
+//   rev. Oct. 17, 2026 first version
+
+#ifndef TASKS_H
+#define TASKS_H
+
+#include "sched.h"
+#include "instrument.h"
+
+#define CONTROL_PERIOD_TICKS  1u    // sensing + control every 1.024 ms (976 Hz)
+#define LED_PERIOD_TICKS      16u   // sensor LEDs at about 61 Hz
+#define REPORT_PERIOD_TICKS   977u  // status line about once a second
+#define EEPROM_PERIOD_TICKS   4u    // a data EEPROM byte write takes about 4 ms
+#define RECORD_PERIOD_TICKS   1u    // the recorder makes a record per control pass
+#define BATTERY_PERIOD_TICKS  32u   // a new battery reading comes about every 40 ms
+#define OBSTACLE_PERIOD_TICKS 4u    // IR detector samples, see obstacle.h for the latency
+#define PERSIST_PERIOD_TICKS  16u   // warm restart state is at most 16 ms old
+
+enum task_id { task_control, task_leds, task_report, task_eeprom, task_battery, task_obstacle,
+#ifdef INSTRUMENT
+               task_probes, task_latency,
+#endif
+#ifdef RECORD
+               task_record,
+#endif
+#ifdef SUPERVISOR
+               task_persist,
+#endif
+               TASKS };
+
+extern struct sched_task tasks[TASKS];
+
+#endif // TASKS_H
@@ -0,0 +1,43 @@
+// telem_frame.h
+//   Binary telemetry frame, shared by the firmware (telemetry.c) and the
+//   host decoder (sim/telem_decode.c).
+//
+//   byte  0      TELEM_SYNC
+//         1      TELEM_VERSION
+//         2      sequence number (wraps at 256)
+//         3-4    time in scheduler ticks of 1.024 ms, low byte first
+//         5-9    low 8 bits of the five ADC readings, left sensor first
+//         10     bits 9:8 of readings 0..3, two bits each, reading 0 lowest
+//         11     bits 1:0: bits 9:8 of reading 4, bits 7:2: 0
+//         12-14  left and right duty cycle, 12 bit two's complement each:
+//                byte 12 left 7:0, byte 13 left 11:8 (low nibble) and
+//                right 3:0 (high nibble), byte 14 right 11:4
+//                -800 .. 800, TELEM_DUTY_BRAKE while dynamic braking
+//         15     CRC-8 (polynomial 0x07, initial value 0) of bytes 1-14
+//
+//   A receiver looks for TELEM_SYNC followed by 15 bytes with a good CRC,
+//   so text printed between frames is skipped.
+//   rev. Oct. 17, 2026 first version
+
+#ifndef TELEM_FRAME_H
+#define TELEM_FRAME_H
+
+#define TELEM_SYNC        0xa5u
+#define TELEM_VERSION     1u
+#define TELEM_FRAME_SIZE  16u
+#define TELEM_DUTY_BRAKE  (-2048)
+
+struct telem_sample
+{
+    unsigned char seq;
+    unsigned int time;               // scheduler ticks
+    unsigned int adc[5];             // 0 to 1023, [0] is the left sensor
+    int duty[2];                     // indexed by enum motor_selection
+};
+
+void telem_pack(const struct telem_sample *s, unsigned char *frame);
+unsigned char telem_unpack(const unsigned char *frame, struct telem_sample *s);
+                 // 1 if frame has the sync byte, this version and a good CRC
+unsigned char telem_crc8(const unsigned char *data, unsigned char n);
+
+#endif // TELEM_FRAME_H
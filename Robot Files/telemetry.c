@@ -0,0 +1,31 @@
+// telemetry.c
+//   Per control pass telemetry frames, see telemetry.h
+//   rev. Oct. 17, 2026 first version
+
+#include "telemetry.h"
+
+#ifdef TELEMETRY
+
+#include "sumovore.h"
+#include "sched.h"
+#include "uart_tx.h"
+#include "telem_frame.h"
+
+unsigned int telemetry_dropped;
+
+void telemetry_send(void)
+{
+    static struct telem_sample sample;
+    unsigned char frame[TELEM_FRAME_SIZE];
+    unsigned char i;
+
+    sample.time = sched_time;
+    for (i = 0; i < LINE_SENSORS; i++) sample.adc[i] = line_adc[i];
+    sample.duty[left] = motor_duty[left];
+    sample.duty[right] = motor_duty[right];
+    telem_pack(&sample, frame);
+    if (!uart_tx_write(frame, TELEM_FRAME_SIZE)) telemetry_dropped++;
+    sample.seq++;            // counts dropped frames too, so the host sees the gap
+}
+
+#endif // TELEMETRY
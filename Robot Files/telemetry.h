@@ -0,0 +1,29 @@
+// telemetry.h
+//   Streams one binary frame (telem_frame.h) per control pass over the
+//   USART: the five raw line sensor readings and both commanded duty
+//   cycles. 16 bytes every 1.024 ms is more than 117647 baud can carry, so
+//   with TELEMETRY defined initialization() sets the USART to 500000 baud.
+//   Frames that do not fit in the transmit buffer are dropped whole and
+//   counted; the sequence number shows the gap on the host.
+//   Not with RECORD, which fills the same link (record.h).
+//   rev. Oct. 17, 2026 first version
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+// #define TELEMETRY     // uncomment (or define it on the compiler command line)
+                         //   to stream telemetry frames at 500000 baud
+
+#ifdef TELEMETRY
+
+extern unsigned int telemetry_dropped;   // frames that did not fit in the buffer
+
+void telemetry_send(void);   // called after motor_control() in the control task
+
+#else
+
+#define telemetry_send()
+
+#endif // TELEMETRY
+
+#endif // TELEMETRY_H
@@ -0,0 +1,81 @@
+// uart_tx.c
+//   USART transmit ring buffer, see uart_tx.h
+//   head is only written by putch(), tail only by the ISR; both are single
+//   bytes so each side reads the other's index atomically.
+//   rev. Oct. 17, 2026 first version
+
+#include "hal.h"
+#include "uart_tx.h"
+
+#define MASK  (UART_TX_SIZE - 1u)
+
+unsigned int uart_tx_dropped;
+
+static unsigned char buffer[UART_TX_SIZE];
+static volatile unsigned char head;   // next free slot
+static volatile unsigned char tail;   // next byte to send
+static unsigned char running;         // set by uart_tx_start()
+
+void uart_tx_start(void)
+{
+    head = tail = 0;
+    running = 1;
+}
+
+void putch(char c)
+{
+    unsigned char next;
+
+    if (!running)
+    {
+        while (!hal_uart_tx_ready());   // before interrupts are on: wait, as before
+        hal_uart_write((unsigned char)c);
+        return;
+    }
+
+    next = (unsigned char)((head + 1u) & MASK);
+    if (next == tail)
+    {
+        uart_tx_dropped++;
+        return;
+    }
+    buffer[head] = (unsigned char)c;
+    head = next;
+    hal_uart_tx_irq(1);   // the ISR runs as soon as TXREG is empty
+}
+
+void uart_tx_isr(void)
+{
+    if (tail == head)
+    {
+        hal_uart_tx_irq(0);   // nothing left, putch() turns it back on
+        return;
+    }
+    hal_uart_write(buffer[tail]);
+    tail = (unsigned char)((tail + 1u) & MASK);
+}
+
+unsigned char uart_tx_free(void)
+{
+    return (unsigned char)((tail - head - 1u) & MASK);
+}
+
+unsigned char uart_tx_write(const unsigned char *data, unsigned char n)
+{
+    unsigned char h;
+
+    if (!running || uart_tx_free() < n)
+    {
+        uart_tx_dropped += n;
+        return 0;
+    }
+    h = head;
+    while (n--)
+    {
+        buffer[h] = *data++;
+        h = (unsigned char)((h + 1u) & MASK);
+    }
+    head = h;             // the ISR sees the whole block at once
+    hal_uart_tx_irq(1);
+    return 1;
+}
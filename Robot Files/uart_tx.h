@@ -0,0 +1,27 @@
+// uart_tx.h
+//   Interrupt driven USART transmit ring buffer.
+//   putch() is the character output routine printf() calls, so every
+//   printf in the firmware now queues its text and returns; the USART
+//   transmit interrupt sends it in the background. When the buffer is full
+//   the new characters are dropped and counted instead of waiting.
+//   Until uart_tx_start() is called (interrupts not yet running) putch()
+//   still waits on the USART, so the reset codes printed from
+//   initialization() and the traps are not lost.
+//   rev. Oct. 17, 2026 first version
+
+#ifndef UART_TX_H
+#define UART_TX_H
+
+#define UART_TX_SIZE  128u   // bytes, must be a power of 2 (at most 256)
+
+extern unsigned int uart_tx_dropped;   // characters dropped because the buffer was full
+
+void putch(char c);
+void uart_tx_start(void);   // switch putch() to the ring buffer, called from initialization()
+void uart_tx_isr(void);     // called from the low priority ISR when TXREG is empty
+unsigned char uart_tx_free(void);   // bytes that can be queued without a drop
+unsigned char uart_tx_write(const unsigned char *data, unsigned char n);
+                 // queues n bytes as one block: all of them or, when they do not
+                 // fit, none (they are counted as dropped). Returns 1 if queued.
+
+#endif // UART_TX_H